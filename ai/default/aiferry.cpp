@@ -13,6 +13,9 @@
 #include <fc_config.h>
 #endif
 
+// Qt
+#include <QSet>
+
 // utility
 #include "log.h"
 
@@ -524,6 +527,24 @@ int aiferry_find_boat(struct ai_type *ait, struct unit *punit, int cap,
     return 0;
   }
 
+  /* Locate the boats we could use up front. The search then only needs
+   * to look at their tiles, and can be skipped altogether if there are
+   * none, e.g. when all available boats are too small for us. */
+  QSet<const struct tile *> boat_tiles;
+
+  unit_list_iterate(pplayer->units, aunit)
+  {
+    if (is_boat_free(ait, aunit, punit, cap)) {
+      boat_tiles.insert(unit_tile(aunit));
+    }
+  }
+  unit_list_iterate_end;
+
+  if (boat_tiles.isEmpty()) {
+    UNIT_LOG(LOGLEVEL_FINDFERRY, punit, "no suitable boat exists");
+    return 0;
+  }
+
   pft_fill_unit_parameter(&param, punit);
   param.omniscience = !has_handicap(pplayer, H_MAP);
   param.get_TB = no_fights_or_unknown;
@@ -548,6 +569,9 @@ int aiferry_find_boat(struct ai_type *ait, struct unit *punit, int cap,
 
     square_iterate(&(wld.map), pos.tile, radius, ptile)
     {
+      if (!boat_tiles.contains(ptile)) {
+        continue;
+      }
       unit_list_iterate(ptile->units, aunit)
       {
         if (is_boat_free(ait, aunit, punit, cap)) {
@@ -942,6 +966,28 @@ static bool aiferry_findcargo(struct ai_type *ait, struct unit *pferry)
   UNIT_LOG(LOGLEVEL_FERRY, pferry, "Ferryboat is looking for cargo.");
 
   pplayer = unit_owner(pferry);
+
+  // Only the tiles of waiting passengers need to be looked at.
+  QSet<const struct tile *> cargo_tiles;
+
+  unit_list_iterate(pplayer->units, aunit)
+  {
+    struct unit_ai *unit_data = def_ai_unit_data(aunit, ait);
+
+    if (unit_data->ferryboat == FERRY_WANTED
+        || unit_data->ferryboat == pferry->id) {
+      cargo_tiles.insert(unit_tile(aunit));
+    }
+  }
+  unit_list_iterate_end;
+
+  if (cargo_tiles.isEmpty()) {
+    UNIT_LOG(LOGLEVEL_FERRY, pferry,
+             "AI Passengers counting reported false positive %d",
+             passengers);
+    return false;
+  }
+
   pft_fill_unit_overlap_param(&parameter, pferry);
   parameter.omniscience = !has_handicap(pplayer, H_MAP);
   /* If we have omniscience, we use it, since paths to some places
@@ -951,6 +997,9 @@ static bool aiferry_findcargo(struct ai_type *ait, struct unit *pferry)
   pfm = pf_map_new(&parameter);
   pf_map_tiles_iterate(pfm, ptile, true)
   {
+    if (!cargo_tiles.contains(ptile)) {
+      continue;
+    }
     unit_list_iterate(ptile->units, aunit)
     {
       struct unit_ai *unit_data = def_ai_unit_data(aunit, ait);
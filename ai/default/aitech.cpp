@@ -51,6 +51,38 @@ struct ai_tech_choice {
                           * or is our current goal */
 };
 
+/**
+   Call 'func' for every valid tech that 'presearch' still has to learn on
+   the way to 'goal', in increasing order. This is the set of techs for
+   which research_goal_tech_req() is TRUE, read from the cached
+   required_techs bitvector one byte at a time so that unrelated parts of
+   the tech tree are skipped.
+ */
+template <typename F>
+static void research_goal_reqs_each(const struct research *presearch,
+                                    Tech_type_id goal, F func)
+{
+  const bv_techs &reqs = presearch->inventions[goal].required_techs;
+  int num_techs = advance_count();
+  size_t byte;
+  int bit;
+
+  for (byte = 0; byte < sizeof(reqs.vec); byte++) {
+    if (reqs.vec[byte] == 0) {
+      continue;
+    }
+    for (bit = 0; bit < 8; bit++) {
+      Tech_type_id tech = byte * 8 + bit;
+
+      if (reqs.vec[byte] & (1u << bit) && tech >= A_FIRST
+          && tech < num_techs && tech != goal
+          && valid_advance_by_number(tech)) {
+        func(tech);
+      }
+    }
+  }
+}
+
 /**
    Massage the numbers provided to us by ai.tech_want into unrecognizable
    pulp.
@@ -108,13 +140,9 @@ static void dai_select_tech(struct ai_type *ait, struct player *pplayer,
       // We only want it if we haven't got it (so AI is human after all)
       if (steps > 0) {
         values[i] += plr_data->tech_want[i];
-        advance_index_iterate(A_FIRST, k)
-        {
-          if (research_goal_tech_req(presearch, i, k)) {
-            values[k] += plr_data->tech_want[i] / steps;
-          }
-        }
-        advance_index_iterate_end;
+        research_goal_reqs_each(presearch, i, [&](Tech_type_id k) {
+          values[k] += plr_data->tech_want[i] / steps;
+        });
       }
     }
   }
@@ -133,13 +161,9 @@ static void dai_select_tech(struct ai_type *ait, struct player *pplayer,
       }
 
       goal_values[i] = values[i];
-      advance_index_iterate(A_FIRST, k)
-      {
-        if (research_goal_tech_req(presearch, i, k)) {
-          goal_values[i] += values[k];
-        }
-      }
-      advance_index_iterate_end;
+      research_goal_reqs_each(presearch, i, [&](Tech_type_id k) {
+        goal_values[i] += values[k];
+      });
 
       /* This is the best I could do.  It still sometimes does freaky stuff
        * like setting goal to Republic and learning Monarchy, but that's what
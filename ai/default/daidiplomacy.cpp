@@ -15,6 +15,7 @@ received a copy of the GNU General Public License along with Freeciv21.
 
 #include <cstdarg>
 #include <cstring>
+#include <vector>
 
 // utility
 #include "fcintl.h"
@@ -1209,20 +1210,25 @@ static void suggest_tech_exchange(struct ai_type *ait,
   }
   advance_index_iterate_end;
 
+  /* Only pair techs player2 would give with techs player1 would give,
+   * rather than testing every pair of techs. */
+  std::vector<Tech_type_id> to_get, to_give;
+
   advance_index_iterate(A_FIRST, tech)
   {
-    if (worth[tech] <= 0) {
-      continue;
+    if (worth[tech] > 0) {
+      to_get.push_back(tech);
+    } else if (worth[tech] < 0) {
+      to_give.push_back(tech);
     }
-    advance_index_iterate(A_FIRST, tech2)
-    {
-      int diff;
+  }
+  advance_index_iterate_end;
 
-      if (worth[tech2] >= 0) {
-        continue;
-      }
+  for (auto tech : to_get) {
+    for (auto tech2 : to_give) {
       // tech2 is given by player1, tech is given by player2
-      diff = worth[tech] + worth[tech2];
+      int diff = worth[tech] + worth[tech2];
+
       if ((diff > 0 && player1->economic.gold >= diff)
           || (diff < 0 && player2->economic.gold >= -diff) || diff == 0) {
         dai_diplomacy_suggest(player1, player2, CLAUSE_ADVANCE, false,
@@ -1236,9 +1242,7 @@ static void suggest_tech_exchange(struct ai_type *ait,
         return;
       }
     }
-    advance_index_iterate_end;
   }
-  advance_index_iterate_end;
 }
 
 /**
@@ -29,6 +29,9 @@
 #include "specialist.h"
 #include "unitlist.h"
 
+// common/aicore
+#include "cm.h"
+
 /* client/include */
 #include "citydlg_g.h"
 #include "mapview_g.h"
@@ -1261,6 +1264,35 @@ int city_change_specialist(struct city *pcity, Specialist_type_id from,
                                              to);
 }
 
+/**
+   Ask the server to arrange the citizens of the city as given in the
+   result, with a single request.  Return the request ID.
+ */
+int city_set_workers(struct city *pcity, const struct cm_result *result)
+{
+  struct packet_city_set_workers packet;
+
+  packet.city_id = pcity->id;
+  packet.worked_count = 0;
+  city_tile_iterate_skip_free_worked(result->city_radius_sq,
+                                     city_tile(pcity), ptile, idx, x, y)
+  {
+    if (result->worker_positions[idx]) {
+      packet.worked[packet.worked_count++] = tile_index(ptile);
+    }
+  }
+  city_tile_iterate_skip_free_worked_end;
+
+  packet.specialists_size = specialist_count();
+  specialist_type_iterate(sp)
+  {
+    packet.specialists[sp] = result->specialists[sp];
+  }
+  specialist_type_iterate_end;
+
+  return send_packet_city_set_workers(&client.conn, &packet);
+}
+
 /**
    Toggle a worker<->specialist at the given city tile.  Return the
    request ID.
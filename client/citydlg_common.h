@@ -18,6 +18,7 @@
 #include "fc_types.h"
 
 class QPixmap;
+struct cm_result;
 struct worklist;
 
 int get_citydlg_canvas_width();
@@ -67,5 +68,6 @@ int city_sell_improvement(struct city *pcity, Impr_type_id sell_id);
 int city_buy_production(struct city *pcity);
 int city_change_specialist(struct city *pcity, Specialist_type_id from,
                            Specialist_type_id to);
+int city_set_workers(struct city *pcity, const struct cm_result *result);
 int city_toggle_worker(struct city *pcity, int city_x, int city_y);
 int city_rename(struct city *pcity, const char *name);
@@ -96,6 +96,7 @@
 #include "packhand.h"
 #include "themes_common.h"
 #include "tilespec.h"
+#include "unit_index.h"
 #include "update_queue.h"
 #include "voteinfo.h"
 
@@ -128,6 +129,7 @@ static void fc_interface_init_client();
 
 namespace /* anonymous */ {
 QUrl url;
+QString replay_filename; // See --replay
 }
 
 QString logfile;
@@ -244,6 +246,7 @@ static void client_game_init()
   client.conn.observer = false;
 
   game_init(false);
+  unit_index_init();
   attribute_init();
   control_init();
   link_marks_init();
@@ -274,6 +277,7 @@ static void client_game_free()
   game.client.ruleset_init = false;
   game.client.ruleset_ready = false;
   game_free();
+  unit_index_free();
   /* update_queue_init() is correct at this point. The queue is reset to
      a clean state which is also needed if the client is not connected to
      the server! */
@@ -379,6 +383,11 @@ int client_main(int argc, char *argv[])
        {{"r", "read"},
         _("Read startup script FILE (for spawned server only)"),
         "FILE"},
+       {"record", _("Record the data received from the server to FILE"),
+        "FILE"},
+       {"replay",
+        _("Handle the data recorded in FILE, print statistics and exit"),
+        "FILE"},
        {{"s", "server"},
         _("Connect to the server at HOST (usually with -a)"),
         "HOST"},
@@ -418,6 +427,12 @@ int client_main(int argc, char *argv[])
     savefile = parser.value(QStringLiteral("file"));
     auto_spawn = true;
   }
+  if (parser.isSet(QStringLiteral("record"))) {
+    record_server_data(parser.value(QStringLiteral("record")));
+  }
+  if (parser.isSet(QStringLiteral("replay"))) {
+    replay_filename = parser.value(QStringLiteral("replay"));
+  }
   if (parser.isSet(QStringLiteral("name"))) {
     url.setUserName(parser.value(QStringLiteral("name")));
   }
@@ -614,6 +629,11 @@ int client_main(int argc, char *argv[])
 
   editor_init();
 
+  if (!replay_filename.isEmpty()) {
+    // Replay as soon as the GUI runs
+    QTimer::singleShot(0, [] { replay_server_data(replay_filename); });
+  }
+
   // run gui-specific client
   ui_main();
 
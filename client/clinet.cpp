@@ -15,7 +15,13 @@
 #include <fc_config.h>
 #endif
 
+#include <cstring>
+
 // Qt
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
 #include <QString>
 #include <QTcpSocket>
 #include <QUrl>
@@ -23,6 +29,7 @@
 // utility
 #include "capstr.h"
 #include "dataio.h"
+#include "fciconv.h"
 #include "fcintl.h"
 #include "log.h"
 #include "registry.h"
@@ -51,6 +58,7 @@
 #include "pages_g.h"
 #include "plrdlg_g.h"
 #include "repodlgs_g.h"
+#include "update_queue.h"
 
 #include "clinet.h"
 
@@ -60,6 +68,9 @@
 // In autoconnect mode, try to connect 100 times
 #define MAX_AUTOCONNECT_ATTEMPTS 100
 
+// Where the data received from the server is recorded, see --record.
+Q_GLOBAL_STATIC(QFile, recording)
+
 /**
    Close socket and cleanup.  This one doesn't print a message, so should
    do so before-hand if necessary.
@@ -283,6 +294,49 @@ static int read_from_connection(struct connection *pc, bool block)
   return ret;
 }
 
+/**
+   Handles the packets waiting in the connection buffer. GUI updates
+   requested by the packets are run once, after all of them. When
+   'discard_sends' is set, the packets sent in reply are thrown away.
+   Returns the number of packets handled.
+ */
+static int handle_server_data(bool discard_sends)
+{
+  int packets = 0;
+
+  governor::i()->freeze();
+  update_queue::uq()->freeze();
+  while (client.conn.used) {
+    enum packet_type type;
+    void *packet = get_packet_from_connection(&client.conn, &type);
+
+    if (NULL != packet) {
+      client_packet_input(packet, type);
+      ::operator delete(packet);
+      packets++;
+
+      if (discard_sends && client.conn.used) {
+        client.conn.send_buffer->ndata = 0;
+      }
+
+      if (type == PACKET_PROCESSING_FINISHED) {
+        if (client.conn.client.last_processed_request_id_seen
+            >= cities_results_request()) {
+          cma_got_result(cities_results_request());
+        }
+      }
+    } else {
+      break;
+    }
+  }
+  if (client.conn.used) {
+    governor::i()->unfreeze();
+  }
+  update_queue::uq()->thaw();
+
+  return packets;
+}
+
 /**
    This function is called when the client received a new input from the
    server.
@@ -290,33 +344,21 @@ static int read_from_connection(struct connection *pc, bool block)
 void input_from_server(QTcpSocket *sock)
 {
   int nb;
+  unsigned long old_size;
 
   fc_assert_ret(sock == client.conn.sock);
 
+  old_size = client.conn.buffer->ndata;
   nb = read_from_connection(&client.conn, false);
   if (0 <= nb) {
-    governor::i()->freeze();
-    while (client.conn.used) {
-      enum packet_type type;
-      void *packet = get_packet_from_connection(&client.conn, &type);
-
-      if (NULL != packet) {
-        client_packet_input(packet, type);
-        ::operator delete(packet);
-
-        if (type == PACKET_PROCESSING_FINISHED) {
-          if (client.conn.client.last_processed_request_id_seen
-              >= cities_results_request()) {
-            cma_got_result(cities_results_request());
-          }
-        }
-      } else {
-        break;
-      }
-    }
-    if (client.conn.used) {
-      governor::i()->unfreeze();
+    if (recording->isOpen() && client.conn.buffer->ndata > old_size) {
+      QDataStream out(recording());
+
+      out << QByteArray(reinterpret_cast<const char *>(
+                            client.conn.buffer->data + old_size),
+                        client.conn.buffer->ndata - old_size);
     }
+    handle_server_data(false);
   } else if (-2 == nb) {
     connection_close(&client.conn, _("server disconnected"));
   } else {
@@ -324,6 +366,91 @@ void input_from_server(QTcpSocket *sock)
   }
 }
 
+/**
+   Records all the data received from the server to 'filename', one block
+   per read, for replay_server_data().
+ */
+void record_server_data(const QString &filename)
+{
+  recording->setFileName(filename);
+  if (!recording->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qCritical(_("Cannot record the server data to %s: %s"),
+              qUtf8Printable(filename),
+              qUtf8Printable(recording->errorString()));
+  }
+}
+
+/**
+   Feeds the data recorded by record_server_data() to the packet handlers,
+   in the same blocks as it was received, without any server. Packets sent
+   in reply are thrown away. Prints how many packets were handled, how
+   many GUI updates they requested and ran, and how long it took, then
+   quits the client.
+ */
+void replay_server_data(const QString &filename)
+{
+  QFile file(filename);
+  QElapsedTimer timer;
+  int blocks = 0, packets = 0;
+  int requested = update_queue::uq()->num_requested();
+  int run = update_queue::uq()->num_run();
+
+  if (!file.open(QIODevice::ReadOnly)) {
+    qCritical(_("Cannot replay %s: %s"), qUtf8Printable(filename),
+              qUtf8Printable(file.errorString()));
+    QCoreApplication::exit(EXIT_FAILURE);
+    return;
+  }
+
+  // Never save the options of a replay
+  gui_options.save_options_on_exit = false;
+
+  /* Set the connection up as make_connection() does, with a socket that
+   * is never connected. Nothing is ever written to it. */
+  connections_set_close_callback(client_conn_close_callback);
+  connection_common_init(&client.conn);
+  client.conn.sock = new QTcpSocket;
+  client.conn.client.last_request_id_used = 0;
+  client.conn.client.last_processed_request_id_seen = 0;
+  client.conn.client.request_id_of_currently_handled_packet = 0;
+  client.conn.incoming_packet_notify = notify_about_incoming_packet;
+  client.conn.outgoing_packet_notify = notify_about_outgoing_packet;
+  connection_do_buffer(&client.conn);
+
+  QDataStream in(&file);
+  timer.start();
+  while (!in.atEnd() && client.conn.used) {
+    struct socket_packet_buffer *buffer = client.conn.buffer;
+    QByteArray block;
+
+    in >> block;
+    if (in.status() != QDataStream::Ok) {
+      qCritical(_("%s is truncated."), qUtf8Printable(filename));
+      break;
+    }
+    if (buffer->nsize - buffer->ndata < unsigned(block.size())) {
+      buffer->nsize = buffer->ndata + block.size();
+      buffer->data = static_cast<unsigned char *>(
+          fc_realloc(buffer->data, buffer->nsize));
+    }
+    memcpy(buffer->data + buffer->ndata, block.constData(), block.size());
+    buffer->ndata += block.size();
+
+    packets += handle_server_data(true);
+    blocks++;
+  }
+
+  fc_printf("replay: %d blocks, %d packets, %d GUI updates requested, "
+            "%d run, %.3f ms\n",
+            blocks, packets, update_queue::uq()->num_requested() - requested,
+            update_queue::uq()->num_run() - run, timer.nsecsElapsed() / 1e6);
+
+  if (client.conn.used) {
+    disconnect_from_server();
+  }
+  QCoreApplication::exit(EXIT_SUCCESS);
+}
+
 static bool autoconnecting = false;
 /**
    Make an attempt to autoconnect to the server.
@@ -20,6 +20,8 @@ int connect_to_server(const QUrl &url, char *errbuf, int errbufsize);
 void make_connection(QTcpSocket *sock, const QString &username);
 
 void input_from_server(QTcpSocket *sock);
+void record_server_data(const QString &filename);
+void replay_server_data(const QString &filename);
 void disconnect_from_server();
 
 double try_to_autoconnect(const QUrl &url);
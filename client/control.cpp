@@ -52,6 +52,7 @@
 #include "options.h"
 #include "overview_common.h"
 #include "tilespec.h"
+#include "unit_index.h"
 #include "update_queue.h"
 
 #include "control.h"
@@ -1645,14 +1646,24 @@ void request_unit_select(struct unit_list *punits,
       }
       unit_list_iterate_end;
     }
+  } else if (seltype == SELTYPE_SAME) {
+    // Only visit units of the wanted types.
+    for (const auto *ptype : qAsConst(type_table)) {
+      for (auto *punit : player_units_by_type(pplayer, ptype)) {
+        if (selloc == SELLOC_CONT
+            && !cont_table.contains(tile_continent(unit_tile(punit)))) {
+          continue;
+        }
+
+        unit_focus_add(punit);
+      }
+    }
   } else {
     unit_list_iterate(pplayer->units, punit)
     {
       ptile = unit_tile(punit);
-      if ((seltype == SELTYPE_SAME
-           && !type_table.contains(unit_type_get(punit)))
-          || (selloc == SELLOC_CONT
-              && !cont_table.contains(tile_continent(ptile)))) {
+      if (selloc == SELLOC_CONT
+          && !cont_table.contains(tile_continent(ptile))) {
         continue;
       }
 
@@ -18,6 +18,7 @@
 #include <cstring>
 
 // Qt
+#include <QHash>
 #include <QLoggingCategory>
 
 // common
@@ -54,6 +55,31 @@ struct part {
   struct pf_map *map;
 };
 
+/*
+ * The start of a patrol return path search: where the last part ends, or
+ * the start of the template when it doesn't move.
+ */
+struct return_path_key {
+  int tile_index;
+  int moves_left, fuel_left;
+
+  bool operator==(const return_path_key &other) const
+  {
+    return (tile_index == other.tile_index && moves_left == other.moves_left
+            && fuel_left == other.fuel_left);
+  }
+};
+
+inline uint qHash(const return_path_key &key, uint seed = 0)
+{
+  return ::qHash((key.tile_index * 31 + key.moves_left) * 31
+                     + key.fuel_left,
+                 seed);
+}
+
+// Upper bound on the number of cached patrol return paths.
+#define MAX_CACHED_RETURN_PATHS 256
+
 struct goto_map {
   struct unit *focus;
   struct part *parts;
@@ -67,6 +93,11 @@ struct goto_map {
     } patrol;
   };
   struct pf_parameter ttemplate;
+  /* Patrol return paths already searched, NULL when there is none. The
+   * mouse tends to hover over the same tiles again and again. Only valid
+   * for the world_generation they were searched in. */
+  QHash<return_path_key, struct pf_path *> return_paths;
+  int return_paths_generation;
 };
 
 // get 'struct goto_map_list' and related functions:
@@ -89,9 +120,13 @@ struct goto_map {
 
 static struct goto_map_list *goto_maps = NULL;
 static bool goto_warned = false;
+/* Bumped by goto_world_changed() whenever the server tells about a change
+ * that can affect path finding. */
+static int world_generation = 0;
 
 static void reset_last_part(struct goto_map *goto_map);
 static void remove_last_part(struct goto_map *goto_map);
+static void clear_return_paths(struct goto_map *goto_map);
 static void fill_parameter_part(struct pf_parameter *param,
                                 const struct goto_map *goto_map,
                                 const struct part *p);
@@ -111,6 +146,7 @@ static struct goto_map *goto_map_new(struct unit *punit)
   goto_map->focus = punit;
   goto_map->parts = NULL;
   goto_map->num_parts = 0;
+  goto_map->return_paths_generation = world_generation;
 
   return goto_map;
 }
@@ -129,7 +165,8 @@ static void goto_map_free(struct goto_map *goto_map)
   if (hover_state == HOVER_PATROL && goto_map->patrol.return_path) {
     pf_path_destroy(goto_map->patrol.return_path);
   }
-  free(goto_map);
+  clear_return_paths(goto_map);
+  delete goto_map;
 }
 
 /**
@@ -271,6 +308,67 @@ static void goto_path_undraw(const struct pf_path *path)
   }
 }
 
+/**
+   Destroys the cached patrol return paths of the goto map.
+ */
+static void clear_return_paths(struct goto_map *goto_map)
+{
+  for (auto *path : qAsConst(goto_map->return_paths)) {
+    if (path != NULL) {
+      pf_path_destroy(path);
+    }
+  }
+  goto_map->return_paths.clear();
+}
+
+/**
+   Returns the path from the end of the part 'p' back to the start of the
+   patrol, or NULL if there is none. The returned path is a copy owned by
+   the caller; searches are cached per start of the search until the
+   world changes.
+ */
+static struct pf_path *patrol_return_path(struct goto_map *goto_map,
+                                          const struct part *p)
+{
+  struct pf_parameter parameter;
+  struct pf_path *path;
+
+  if (goto_map->return_paths_generation != world_generation) {
+    clear_return_paths(goto_map);
+    goto_map->return_paths_generation = world_generation;
+  }
+
+  fill_parameter_part(&parameter, goto_map, p);
+
+  const return_path_key key = {tile_index(parameter.start_tile),
+                               parameter.moves_left_initially,
+                               parameter.fuel_left_initially};
+  auto cached = goto_map->return_paths.constFind(key);
+
+  if (cached != goto_map->return_paths.constEnd()) {
+    path = *cached;
+  } else {
+    struct pf_map *pfm = pf_map_new(&parameter);
+
+    path = pf_map_path(pfm, goto_map->parts[0].start_tile);
+    pf_map_destroy(pfm);
+
+    if (goto_map->return_paths.size() >= MAX_CACHED_RETURN_PATHS) {
+      clear_return_paths(goto_map);
+    }
+    goto_map->return_paths.insert(key, path);
+  }
+
+  return path != NULL ? pf_path_concat(NULL, path) : NULL;
+}
+
+/**
+   Tells the goto code that something the path finding depends on (tiles,
+   units, cities or diplomatic states) has changed, so that cached
+   searches are not used anymore.
+ */
+void goto_world_changed() { world_generation++; }
+
 /**
    Change the destination of the last part to the given location.
    If a path cannot be found, the destination is set to the start.
@@ -329,14 +427,7 @@ static bool update_last_part(struct goto_map *goto_map, struct tile *ptile)
   p->end_fuel_left = pf_path_last_position(new_path)->fuel_left;
 
   if (hover_state == HOVER_PATROL) {
-    struct pf_parameter parameter;
-    struct pf_map *pfm;
-    struct pf_path *return_path;
-
-    fill_parameter_part(&parameter, goto_map, p);
-    pfm = pf_map_new(&parameter);
-    return_path = pf_map_path(pfm, goto_map->parts[0].start_tile);
-    pf_map_destroy(pfm);
+    struct pf_path *return_path = patrol_return_path(goto_map, p);
 
     if (return_path == NULL) {
       qCDebug(goto_category, "  no return path found");
@@ -31,6 +31,7 @@ void enter_goto_state(struct unit_list *punits);
 void exit_goto_state();
 
 void goto_unit_killed(struct unit *punit);
+void goto_world_changed();
 
 bool goto_is_active();
 bool goto_get_turns(int *min, int *max);
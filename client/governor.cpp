@@ -10,6 +10,8 @@
 *-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*/
 
 #include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
 
 // utility
 #include "bugs.h"
@@ -23,8 +25,11 @@
 #include "specialist.h"
 // client
 #include "attribute.h"
+#include "citydlg_common.h"
 #include "client_main.h"
 #include "climisc.h"
+#include "options.h"
+#include "update_queue.h"
 
 // include
 #include "citydlg_g.h"
@@ -63,7 +68,7 @@ struct cma_preset {
 };
 
 static struct {
-  int apply_result_ignored, apply_result_applied, refresh_forced;
+  int apply_result_ignored, apply_result_applied;
 } stats;
 
 governor *governor::m_instance = nullptr;
@@ -85,15 +90,24 @@ public:
   void handle_city(struct city *pcity);
   int get_request();
   void result_came_from_server(int request);
+  void server_request_done(int city_id);
 
 private:
+  void hand_over_to_server(struct city *pcity,
+                           const struct cm_parameter *parameter);
   struct city *check_city(int city_id, struct cm_parameter *parameter);
   bool apply_result_on_server(struct city *pcity,
                               const struct cm_result *result);
+  bool handle_city_on_server(struct city *pcity);
   struct cm_result *cma_state_result;
   const struct cm_result *cma_result_got;
   int last_request;
   struct city *xcity;
+  /* Cities handed to the server-side governor, not yet confirmed, with
+   * the id of the request. */
+  QHash<int, int> server_pending;
+  // Cities the server-side governor was seen running for.
+  QSet<int> server_governed;
 };
 
 // gimb means "governor is my bitch"
@@ -281,10 +295,8 @@ cma_yoloswag::~cma_yoloswag() = default;
 bool cma_yoloswag::apply_result_on_server(struct city *pcity,
                                           const struct cm_result *result)
 {
-  int first_request_id = 0, last_request_id = 0, i;
-  int city_radius_sq = city_map_radius_sq_get(pcity);
+  int last_request_id;
   struct cm_result *current_state;
-  struct tile *pcenter = city_tile(pcity);
 
   fc_assert_ret_val(result->found_a_valid, false);
   current_state = cm_result_new(pcity);
@@ -308,99 +320,10 @@ bool cma_yoloswag::apply_result_on_server(struct city *pcity,
   log_apply_result("apply_result_on_server(city %d=\"%s\")", pcity->id,
                    city_name_get(pcity));
 
-  connection_do_buffer(&client.conn);
-
-  // Remove all surplus workers
-  city_tile_iterate_skip_free_worked(city_radius_sq, pcenter, ptile, idx, x,
-                                     y)
-  {
-    if (tile_worked(ptile) == pcity && !result->worker_positions[idx]) {
-      log_apply_result("Removing worker at {%d,%d}.", x, y);
-
-      last_request_id = dsend_packet_city_make_specialist(
-          &client.conn, pcity->id, ptile->index);
-      if (first_request_id == 0) {
-        first_request_id = last_request_id;
-      }
-    }
-  }
-  city_tile_iterate_skip_free_worked_end;
-
-  // Change the excess non-default specialists to default.
-  specialist_type_iterate(sp)
-  {
-    if (sp == DEFAULT_SPECIALIST) {
-      continue;
-    }
-
-    for (i = 0; i < pcity->specialists[sp] - result->specialists[sp]; i++) {
-      log_apply_result("Change specialist from %d to %d.", sp,
-                       DEFAULT_SPECIALIST);
-      last_request_id =
-          city_change_specialist(pcity, sp, DEFAULT_SPECIALIST);
-      if (first_request_id == 0) {
-        first_request_id = last_request_id;
-      }
-    }
-  }
-  specialist_type_iterate_end;
-
-  // now all surplus people are DEFAULT_SPECIALIST
-
-  // Set workers
-  /* FIXME: This code assumes that any toggled worker will turn into a
-   * DEFAULT_SPECIALIST! */
-  city_tile_iterate_skip_free_worked(city_radius_sq, pcenter, ptile, idx, x,
-                                     y)
-  {
-    if (NULL == tile_worked(ptile) && result->worker_positions[idx]) {
-      log_apply_result("Putting worker at {%d,%d}.", x, y);
-      fc_assert_action(city_can_work_tile(pcity, ptile), break);
-
-      last_request_id = dsend_packet_city_make_worker(
-          &client.conn, pcity->id, ptile->index);
-      if (first_request_id == 0) {
-        first_request_id = last_request_id;
-      }
-    }
-  }
-  city_tile_iterate_skip_free_worked_end;
-
-  /* Set all specialists except DEFAULT_SPECIALIST (all the unchanged
-   * ones remain as DEFAULT_SPECIALIST). */
-  specialist_type_iterate(sp)
-  {
-    if (sp == DEFAULT_SPECIALIST) {
-      continue;
-    }
-
-    for (i = 0; i < result->specialists[sp] - pcity->specialists[sp]; i++) {
-      log_apply_result("Changing specialist from %d to %d.",
-                       DEFAULT_SPECIALIST, sp);
-      last_request_id =
-          city_change_specialist(pcity, DEFAULT_SPECIALIST, sp);
-      if (first_request_id == 0) {
-        first_request_id = last_request_id;
-      }
-    }
-  }
-  specialist_type_iterate_end;
-
-  if (last_request_id == 0 || ALWAYS_APPLY_AT_SERVER) {
-    /*
-     * If last_request is 0 no change request was send. But it also
-     * means that the results are different or the fc_results_are_equal()
-     * test at the start of the function would be true. So this
-     * means that the client has other results for the same
-     * allocation of citizen than the server. We just send a
-     * PACKET_CITY_REFRESH to bring them in sync.
-     */
-    first_request_id = dsend_packet_city_refresh(&client.conn, pcity->id);
-    last_request_id = first_request_id;
-    stats.refresh_forced++;
-  }
-
-  connection_do_unbuffer(&client.conn);
+  /* Send the whole arrangement at once, the server replies with a single
+   * city info. This also brings the city back in sync when the client has
+   * other results for the same allocation of citizens than the server. */
+  last_request_id = city_set_workers(pcity, result);
 
   cma_result_got = result;
   cma_state_result = current_state;
@@ -409,6 +332,26 @@ bool cma_yoloswag::apply_result_on_server(struct city *pcity,
   return true;
 }
 
+/**
+   Ask the server to run the citizen governor of the city with the given
+   parameter, or to stop running it if parameter is NULL. Returns the
+   request id.
+ */
+static int send_city_manager(const struct city *pcity,
+                             const struct cm_parameter *parameter)
+{
+  struct packet_city_manager packet;
+
+  packet.city_id = pcity->id;
+  packet.enabled = (parameter != NULL);
+  if (parameter != NULL) {
+    cm_copy_parameter(&packet.parameter, parameter);
+  } else {
+    cm_init_parameter(&packet.parameter);
+  }
+  return send_packet_city_manager(&client.conn, &packet);
+}
+
 void cma_yoloswag::put_city_under_agent(
     struct city *pcity, const struct cm_parameter *const parameter)
 {
@@ -416,13 +359,23 @@ void cma_yoloswag::put_city_under_agent(
             city_name_get(pcity));
   fc_assert_ret(city_owner(pcity) == client.conn.playing);
   cma_set_parameter(ATTR_CITY_CMA_PARAMETER, pcity->id, parameter);
-  governor::i()->add_city_changed(pcity);
+  if (gui_options.server_side_governor) {
+    // The server rearranges the city and replies with one city_info.
+    hand_over_to_server(pcity, parameter);
+  } else {
+    governor::i()->add_city_changed(pcity);
+  }
   log_debug("cma_put_city_under_agent: return");
 }
 
 void cma_yoloswag::release_city(struct city *pcity)
 {
   attr_city_set(ATTR_CITY_CMA_PARAMETER, pcity->id, 0, NULL);
+  server_pending.remove(pcity->id);
+  server_governed.remove(pcity->id);
+  if (pcity->cm_parameter && can_client_issue_orders()) {
+    send_city_manager(pcity, NULL);
+  }
   refresh_city_dialog(pcity);
   city_report_dialog_update_city(pcity);
 }
@@ -543,6 +496,107 @@ struct city *cma_yoloswag::check_city(int city_id,
   return pcity;
 }
 
+/**
+   Update queue callback for the end of a request handing a city over.
+ */
+static void server_request_done_cb(void *data)
+{
+  gimb->server_request_done(FC_PTR_TO_INT(data));
+}
+
+/**
+   Asks the server-side governor to take care of the city.
+ */
+void cma_yoloswag::hand_over_to_server(struct city *pcity,
+                                       const struct cm_parameter *parameter)
+{
+  int request = send_city_manager(pcity, parameter);
+
+  server_pending.insert(pcity->id, request);
+  update_queue::uq()->connect_processing_finished(
+      request, server_request_done_cb, FC_INT_TO_PTR(pcity->id));
+}
+
+/**
+   The server has processed a request handing the city over. Its reply
+   comes before the end of the request, so if the server governor gave up
+   right away the city could not be released when the reply arrived: do
+   it now.
+ */
+void cma_yoloswag::server_request_done(int city_id)
+{
+  struct city *pcity = game_city_by_number(city_id);
+
+  if (!server_pending.contains(city_id)
+      || (client.conn.client.last_processed_request_id_seen
+          < server_pending.value(city_id))) {
+    // Already settled, or an older request
+    return;
+  }
+
+  if (pcity == NULL || city_owner(pcity) != client.conn.playing) {
+    server_pending.remove(city_id);
+  } else if (pcity->cm_parameter != NULL) {
+    server_pending.remove(city_id);
+    server_governed.insert(city_id);
+  } else {
+    // The server gave up and passed back control. It notified the player.
+    cma_release_city(pcity);
+  }
+}
+
+/**
+   Keep the server-side governor of the city in sync with the client
+   state. Returns TRUE if the server takes care of the city, in which case
+   nothing has to be done in the client.
+ */
+bool cma_yoloswag::handle_city_on_server(struct city *pcity)
+{
+  struct cm_parameter parameter;
+  bool on_server = (pcity->cm_parameter != NULL);
+  int city_id = pcity->id;
+
+  if (on_server) {
+    server_pending.remove(city_id);
+  }
+
+  if (!gui_options.server_side_governor) {
+    if (on_server) {
+      // Take the city back from the server.
+      send_city_manager(pcity, NULL);
+    }
+    server_pending.remove(city_id);
+    server_governed.remove(city_id);
+    return false;
+  }
+
+  if (pcity != check_city(city_id, &parameter)) {
+    // Not governed, make sure the server agrees.
+    if (on_server && city_owner(pcity) == client.conn.playing
+        && can_client_issue_orders()) {
+      send_city_manager(pcity, NULL);
+    }
+    server_governed.remove(city_id);
+    return true;
+  }
+
+  if (on_server) {
+    server_governed.insert(city_id);
+  } else if (server_governed.contains(city_id)
+             || (server_pending.contains(city_id)
+                 && (client.conn.client.last_processed_request_id_seen
+                     >= server_pending.value(city_id)))) {
+    /* The server gave up and passed back control. It already notified
+     * the player. */
+    cma_release_city(pcity);
+  } else if (!server_pending.contains(city_id)) {
+    // Governed by the client so far, hand it over.
+    hand_over_to_server(pcity, &parameter);
+  }
+
+  return true;
+}
+
 /**
    The given city has changed. handle_city ensures that either the city
    follows the set CMA goal or that the CMA detaches itself from the
@@ -550,11 +604,16 @@ struct city *cma_yoloswag::check_city(int city_id,
  */
 void cma_yoloswag::handle_city(struct city *pcity)
 {
-  auto result = std::unique_ptr<cm_result, typeof(&cm_result_destroy)>(
-      cm_result_new(pcity), &cm_result_destroy);
   bool handled;
   int i, city_id = pcity->id;
 
+  if (handle_city_on_server(pcity)) {
+    return;
+  }
+
+  auto result = std::unique_ptr<cm_result, typeof(&cm_result_destroy)>(
+      cm_result_new(pcity), &cm_result_destroy);
+
   log_handle_city("handle_city(city %d=\"%s\") pos=(%d,%d) owner=%s",
                   pcity->id, city_name_get(pcity), TILE_XY(pcity->tile),
                   nation_rule_name(nation_of_city(pcity)));
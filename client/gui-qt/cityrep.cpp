@@ -115,13 +115,22 @@ QSize city_item_delegate::sizeHint(const QStyleOptionViewItem &option,
 /**
    Constructor for city item
  */
-city_item::city_item(city *pcity) : QObject() { i_city = pcity; }
+city_item::city_item(city *pcity)
+    : QObject(), cells(NUM_CREPORT_COLS), cached(NUM_CREPORT_COLS)
+{
+  i_city = pcity;
+}
 
 /**
    Returns used city pointer for city item creation
  */
 city *city_item::get_city() { return i_city; }
 
+/**
+   Forgets the cached column texts after the city changed
+ */
+void city_item::invalidate() { cached.fill(false); }
+
 /**
    Sets nothing, but must be declared
  */
@@ -146,9 +155,13 @@ QVariant city_item::data(int column, int role) const
   if (role != Qt::DisplayRole) {
     return QVariant();
   }
-  spec = city_report_specs + column;
-  QString buf = QStringLiteral("%1").arg(spec->func(i_city, spec->data));
-  return buf.trimmed();
+  if (!cached.testBit(column)) {
+    spec = city_report_specs + column;
+    cells[column] =
+        QStringLiteral("%1").arg(spec->func(i_city, spec->data)).trimmed();
+    cached.setBit(column);
+  }
+  return cells[column];
 }
 
 /**
@@ -166,6 +179,7 @@ city_model::~city_model()
 {
   qDeleteAll(city_list);
   city_list.clear();
+  city_rows.clear();
 }
 
 /**
@@ -284,6 +298,7 @@ void city_model::populate()
     city_list_iterate(client_player()->cities, pcity)
     {
       ci = new city_item(pcity);
+      city_rows.insert(pcity, city_list.size());
       city_list << ci;
     }
     city_list_iterate_end;
@@ -291,6 +306,7 @@ void city_model::populate()
     cities_iterate(pcity)
     {
       ci = new city_item(pcity);
+      city_rows.insert(pcity, city_list.size());
       city_list << ci;
     }
     cities_iterate_end;
@@ -302,16 +318,25 @@ void city_model::populate()
  */
 void city_model::city_changed(struct city *pcity)
 {
-  city_item *item;
+  int row = city_rows.value(pcity, -1);
 
-  beginResetModel();
-  endResetModel();
-  for (int i = 0; i < city_list.count(); i++) {
-    item = city_list.at(i);
-    if (pcity == item->get_city()) {
-      notify_city_changed(i);
+  if (row < 0) {
+    // Only cities shown by populate() get a row.
+    if (client_has_player() && city_owner(pcity) != client_player()) {
+      return;
     }
+    row = city_list.size();
+    beginInsertRows(QModelIndex(), row, row);
+    city_rows.insert(pcity, row);
+    city_list << new city_item(pcity);
+    endInsertRows();
+    return;
   }
+
+  /* Only this row is recomputed, and the sort model only moves this row
+   * instead of sorting everything again. */
+  city_list.at(row)->invalidate();
+  notify_city_changed(row);
 }
 
 /**
@@ -319,8 +344,10 @@ void city_model::city_changed(struct city *pcity)
  */
 void city_model::all_changed()
 {
-  city_list.clear();
   beginResetModel();
+  qDeleteAll(city_list);
+  city_list.clear();
+  city_rows.clear();
   populate();
   endResetModel();
 }
@@ -1081,8 +1108,8 @@ void city_widget::gen_production_labels(city_widget::menu_labels what,
  */
 void city_widget::update_city(city *pcity)
 {
+  // The selection survives, since the model isn't reset.
   list_model->city_changed(pcity);
-  restore_selection();
 }
 
 /**
@@ -11,10 +11,13 @@
 
 // Qt
 #include <QAbstractListModel>
+#include <QBitArray>
+#include <QHash>
 #include <QItemDelegate>
 #include <QMenu>
 #include <QSortFilterProxyModel>
 #include <QTreeView>
+#include <QVector>
 #include <QWidget>
 // client
 #include "cityrepdata.h"
@@ -77,9 +80,13 @@ public:
   bool setData(int column, const QVariant &value,
                int role = Qt::DisplayRole);
   struct city *get_city();
+  void invalidate();
 
 private:
   struct city *i_city;
+  // Text of each column, computed when the view first asks for it
+  mutable QVector<QString> cells;
+  mutable QBitArray cached;
 };
 
 /***************************************************************************
@@ -118,6 +125,7 @@ private slots:
 
 private:
   QList<city_item *> city_list;
+  QHash<const struct city *, int> city_rows;
 };
 
 /***************************************************************************
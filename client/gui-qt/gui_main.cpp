@@ -8,10 +8,6 @@
  see https://www.gnu.org/licenses/.
 **************************************************************************/
 
-#ifdef AUDIO_SDL
-#include <SDL2/SDL.h>
-#endif // AUDIO_SDL
-
 #include "gui_main.h"
 #include <cstdio>
 // Qt
@@ -64,15 +60,6 @@ class fc_client *king() { return freeciv_qt; }
  */
 void qtg_ui_init() {}
 
-/**
-   Entry point for whole freeciv client program.
- */
-int main(int argc, char **argv)
-{
-  setup_gui_funcs();
-  return client_main(argc, argv);
-}
-
 /**
    Migrate Qt client specific options from freeciv-2.5 options
  */
@@ -0,0 +1,31 @@
+/**************************************************************************
+ Copyright (c) 1996-2020 Freeciv21 and Freeciv contributors. This file is
+ part of Freeciv21. Freeciv21 is free software: you can redistribute it
+ and/or modify it under the terms of the GNU  General Public License  as
+ published by the Free Software Foundation, either version 3 of the
+ License,  or (at your option) any later version. You should have received
+ a copy of the GNU General Public License along with Freeciv21. If not,
+ see https://www.gnu.org/licenses/.
+**************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#ifdef AUDIO_SDL
+#include <SDL2/SDL.h>
+#endif // AUDIO_SDL
+
+// client
+#include "client_main.h"
+// gui-qt
+#include "qtg_cxxside.h"
+
+/**
+   Entry point for whole freeciv client program.
+ */
+int main(int argc, char **argv)
+{
+  setup_gui_funcs();
+  return client_main(argc, argv);
+}
@@ -23,6 +23,7 @@
 #include "climisc.h"
 #include "mapview_common.h"
 #include "sprite.h"
+#include "unit_index.h"
 // gui-qt
 #include "canvas.h"
 #include "fc_client.h"
@@ -357,11 +358,9 @@ void unittype_item::wheelEvent(QWheelEvent *event)
     return;
   }
 
-  unit_list_iterate(client_player()->units, punit)
-  {
-    if (punit->utype != utype) {
-      continue;
-    }
+  const auto &units = player_units_by_type(client_player(), utype);
+
+  for (auto *punit : units) {
     if (ACTIVITY_IDLE == punit->activity
         || ACTIVITY_SENTRY == punit->activity) {
       if (can_unit_do_activity(punit, ACTIVITY_IDLE)) {
@@ -369,7 +368,6 @@ void unittype_item::wheelEvent(QWheelEvent *event)
       }
     }
   }
-  unit_list_iterate_end;
 
   if (event->angleDelta().y() < 0) {
     unit_scroll--;
@@ -384,11 +382,7 @@ void unittype_item::wheelEvent(QWheelEvent *event)
 
   unit_count = 0;
 
-  unit_list_iterate(client_player()->units, punit)
-  {
-    if (punit->utype != utype) {
-      continue;
-    }
+  for (auto *punit : units) {
     if (ACTIVITY_IDLE == punit->activity
         || ACTIVITY_SENTRY == punit->activity) {
       if (can_unit_do_activity(punit, ACTIVITY_IDLE)) {
@@ -399,7 +393,6 @@ void unittype_item::wheelEvent(QWheelEvent *event)
       }
     }
   }
-  unit_list_iterate_end;
   event->accept();
 }
 
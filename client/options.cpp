@@ -127,6 +127,7 @@ struct client_options gui_options = {
     true,                           //.enable_cursor_changes =
     false,                          //.separate_unit_selection =
     true,                           //.unit_selection_clears_orders =
+    true,                           //.server_side_governor =
     FT_COLOR("#000000", "#FFFF00"), //.highlight_our_names =
 
     true,  //.voteinfo_bar_use =
@@ -1914,6 +1915,14 @@ static struct client_option client_options[] = {
            "selected, and pressing <space> a second time will "
            "dismiss them."),
         COC_INTERFACE, GUI_STUB, true, NULL),
+    GEN_BOOL_OPTION(
+        server_side_governor, N_("Run the citizen governor on the server"),
+        N_("If this option is enabled, the citizen governor of your "
+           "cities runs on the server, which rearranges the cities "
+           "whenever they change. If it is disabled, the client "
+           "rearranges the cities itself, which needs many more "
+           "messages to be exchanged with the server."),
+        COC_NETWORK, GUI_STUB, true, NULL),
     GEN_BOOL_OPTION(voteinfo_bar_use, N_("Enable vote bar"),
                     N_("If this option is turned on, the vote bar will be "
                        "displayed to show vote information."),
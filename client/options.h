@@ -101,6 +101,7 @@ struct client_options {
   bool enable_cursor_changes;
   bool separate_unit_selection;
   bool unit_selection_clears_orders;
+  bool server_side_governor;
   struct ft_color highlight_our_names;
 
   bool voteinfo_bar_use;
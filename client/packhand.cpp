@@ -94,6 +94,7 @@
 #include "options.h"
 #include "overview_common.h"
 #include "tilespec.h"
+#include "unit_index.h"
 #include "update_queue.h"
 #include "voteinfo.h"
 
@@ -396,6 +397,7 @@ void handle_city_remove(int city_id)
   bool need_menus_update;
 
   fc_assert_ret_msg(NULL != pcity, "Bad city %d.", city_id);
+  goto_world_changed();
 
   need_menus_update = (NULL != get_focus_unit_on_tile(city_tile(pcity)));
 
@@ -426,6 +428,7 @@ void handle_unit_remove(int unit_id)
               unit_id);
     return;
   }
+  goto_world_changed();
 
   // Close diplomat dialog if the diplomat is lost
   if (action_selection_actor_unit() == punit->id) {
@@ -592,6 +595,7 @@ void handle_city_info(const struct packet_city_info *packet)
 
   fc_assert_ret_msg(NULL != powner, "Bad player number %d.", packet->owner);
   fc_assert_ret_msg(NULL != pcenter, "Invalid tile index %d.", packet->tile);
+  goto_world_changed();
 
   if (!universals_n_is_valid(
           static_cast<universals_n>(packet->production_kind))) {
@@ -730,6 +734,17 @@ void handle_city_info(const struct packet_city_info *packet)
 
   pcity->city_options = packet->city_options;
 
+  // Citizen governor running on the server, if any.
+  if (packet->cma_enabled) {
+    if (!pcity->cm_parameter) {
+      pcity->cm_parameter = new cm_parameter[1]();
+    }
+    cm_copy_parameter(pcity->cm_parameter, &packet->cm_parameter);
+  } else if (pcity->cm_parameter) {
+    delete[] pcity->cm_parameter;
+    pcity->cm_parameter = nullptr;
+  }
+
   if (pcity->surplus[O_SCIENCE] != packet->surplus[O_SCIENCE]
       || pcity->waste[O_SCIENCE] != packet->waste[O_SCIENCE]
       || (pcity->unhappy_penalty[O_SCIENCE]
@@ -945,17 +960,12 @@ static void city_packet_common(struct city *pcity, struct tile *pcenter,
       city_report_dialog_update();
     }
 
-    players_iterate(pp)
-    {
-      unit_list_iterate(pp->units, punit)
-      {
-        if (punit->homecity == pcity->id) {
-          unit_list_prepend(pcity->units_supported, punit);
-        }
+    // Units are always supported by a city of their owner.
+    for (auto *punit : units_by_homecity(pcity->id)) {
+      if (unit_owner(punit) == powner) {
+        unit_list_prepend(pcity->units_supported, punit);
       }
-      unit_list_iterate_end;
     }
-    players_iterate_end;
 
     pcity->client.first_citizen_index = fc_rand(MAX_NUM_CITIZEN_SPRITES);
   } else {
@@ -1077,6 +1087,7 @@ void handle_city_short_info(const struct packet_city_short_info *packet)
 
   fc_assert_ret_msg(NULL != powner, "Bad player number %d.", packet->owner);
   fc_assert_ret_msg(NULL != pcenter, "Invalid tile index %d.", packet->tile);
+  goto_world_changed();
 
   if (NULL != pcity) {
     ptile = city_tile(pcity);
@@ -1573,6 +1584,8 @@ static bool handle_unit_packet_common(struct unit *packet_unit)
   bool moved = false;
   bool ret = false;
 
+  goto_world_changed();
+
   punit = player_unit_by_number(unit_owner(packet_unit), packet_unit->id);
   if (!punit && game_unit_by_number(packet_unit->id)) {
     /* This means unit has changed owner. We deal with this here
@@ -1895,6 +1908,7 @@ static bool handle_unit_packet_common(struct unit *packet_unit)
   } /*** End of Create new unit ***/
 
   fc_assert_ret_val(punit != NULL, ret);
+  unit_index_update(punit);
 
   // Check if we have to load the unit on a transporter.
   if (punit->client.transported_by != -1) {
@@ -2574,6 +2588,7 @@ void handle_player_diplstate(const struct packet_player_diplstate *packet)
   bool need_players_dialog_update = false;
 
   fc_assert_ret(ds != NULL);
+  goto_world_changed();
 
   if (client_has_player() && my_player == plr2) {
     if (ds->type != packet->type) {
@@ -2899,6 +2914,7 @@ void handle_tile_info(const struct packet_tile_info *packet)
 
   fc_assert_ret_msg(NULL != ptile, "Invalid tile index %d.", packet->tile);
   old_known = client_tile_get_known(ptile);
+  goto_world_changed();
 
   if (packet->resource != MAX_EXTRA_TYPES) {
     presource = extra_by_number(packet->resource);
@@ -2938,7 +2954,7 @@ void handle_tile_info(const struct packet_tile_info *packet)
     tile_changed = true;
   }
   if (extra_owner(ptile) != eowner) {
-    ptile->extras_owner = eowner;
+    tile_set_extras_owner(ptile, eowner);
     tile_changed = true;
   }
 
@@ -35,6 +35,7 @@
 #include "control.h"
 #include "options.h"
 #include "packhand_gen.h"
+#include "unit_index.h"
 
 #include "repodlgs_common.h"
 
@@ -130,18 +131,13 @@ void get_economy_report_units_data(struct unit_entry *entries,
     count = 0;
     partial_cost = 0;
 
-    city_list_iterate(client.conn.playing->cities, pcity)
-    {
-      unit_list_iterate(pcity->units_supported, punit)
-      {
-        if (unit_type_get(punit) == unittype) {
-          count++;
-          partial_cost += punit->upkeep[O_GOLD];
-        }
+    for (const auto *punit :
+         player_units_by_type(client.conn.playing, unittype)) {
+      if (player_city_by_number(client.conn.playing, punit->homecity)) {
+        count++;
+        partial_cost += punit->upkeep[O_GOLD];
       }
-      unit_list_iterate_end;
     }
-    city_list_iterate_end;
 
     if (count == 0) {
       continue;
@@ -226,24 +222,18 @@ void disband_all_units(const struct unit_type *punittype,
     return;
   }
 
-  city_list_iterate(client.conn.playing->cities, pcity)
-  {
-    /* Only supported units are disbanded.  Units with no homecity have no
-     * cost and are not disbanded. */
-    unit_list_iterate(pcity->units_supported, punit)
-    {
-      struct city *incity = tile_city(unit_tile(punit));
-
-      if (unit_type_get(punit) == punittype
-          && (!in_cities_only
-              || (incity && city_owner(incity) == client.conn.playing))) {
-        count++;
-        request_unit_disband(punit);
-      }
+  /* Only supported units are disbanded.  Units with no homecity have no
+   * cost and are not disbanded. */
+  for (auto *punit : player_units_by_type(client.conn.playing, punittype)) {
+    struct city *incity = tile_city(unit_tile(punit));
+
+    if (player_city_by_number(client.conn.playing, punit->homecity)
+        && (!in_cities_only
+            || (incity && city_owner(incity) == client.conn.playing))) {
+      count++;
+      request_unit_disband(punit);
     }
-    unit_list_iterate_end;
   }
-  city_list_iterate_end;
 
   if (count > 0) {
     fc_snprintf(message, message_sz, _("Disbanded %d %s."), count,
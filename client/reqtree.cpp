@@ -13,9 +13,13 @@
 #include <fc_config.h>
 #endif
 
+#include <QByteArray>
+#include <QHash>
 #include <QRect>
+#include <algorithm>
 #include <cstdarg>
 #include <cstring>
+#include <vector>
 
 // utility
 #include "log.h"
@@ -351,8 +355,7 @@ static struct reqtree *create_dummy_reqtree(struct player *pplayer,
   const struct research *presearch = research_get(pplayer);
   struct reqtree *tree = new reqtree();
   int j;
-  std::vector<struct tree_node *> nodes;
-  nodes.reserve(advance_count());
+  std::vector<struct tree_node *> nodes(advance_count(), nullptr);
 
   nodes[A_NONE] = NULL;
   advance_index_iterate(A_FIRST, tech)
@@ -610,8 +613,7 @@ static void set_layers(struct reqtree *tree)
 
   {
     // Counters for order - order number for the next node in the layer
-    std::vector<int> T;
-    T.reserve(num_layers);
+    std::vector<int> T(num_layers, 0);
 
     tree->layers = new tree_node **[num_layers];
     tree->layer_size = new int[num_layers];
@@ -644,16 +646,16 @@ struct node_and_float {
 /**
    Comparison function used by barycentric_sort.
  */
-static int cmp_func(const node_and_float &a, const node_and_float &b)
+static bool cmp_func(const node_and_float &a, const node_and_float &b)
 {
   return a.value < b.value;
 }
 
 /**
    Simple heuristic: Sort nodes on the given layer by the average x-value
-   of its' parents.
+   of their parents, or of their children if 'upward' is set.
  */
-static void barycentric_sort(struct reqtree *tree, int layer)
+static void barycentric_sort(struct reqtree *tree, int layer, bool upward)
 {
   std::vector<struct node_and_float> T;
   T.resize(tree->layer_size[layer]);
@@ -663,18 +665,23 @@ static void barycentric_sort(struct reqtree *tree, int layer)
 
   for (i = 0; i < tree->layer_size[layer]; i++) {
     struct tree_node *node = tree->layers[layer][i];
+    int nadj = upward ? node->nprovide : node->nrequire;
+    struct tree_node **adj = upward ? node->provide : node->require;
 
     T[i].node = node;
-    v = 0.0;
-    for (j = 0; j < node->nrequire; j++) {
-      v += node->require[j]->order;
-    }
-    if (node->nrequire > 0) {
-      v /= static_cast<float>(node->nrequire);
+    if (nadj > 0) {
+      v = 0.0;
+      for (j = 0; j < nadj; j++) {
+        v += adj[j]->order;
+      }
+      v /= static_cast<float>(nadj);
+    } else {
+      // Nodes without neighbours keep their place
+      v = node->order;
     }
     T[i].value = v;
   }
-  std::sort(T.begin(), T.end(), cmp_func);
+  std::stable_sort(T.begin(), T.end(), cmp_func);
 
   for (i = 0; i < tree->layer_size[layer]; i++) {
     tree->layers[layer][i] = T[i].node;
@@ -684,31 +691,54 @@ static void barycentric_sort(struct reqtree *tree, int layer)
 
 /**
    Calculate number of edge crossings beetwen layer and layer+1
+
+   The edges are visited sorted by their start in layer, and a Fenwick
+   tree indexed by the order in layer+1 counts the edges already seen, so
+   this is O(E log V).
  */
 static int count_crossings(struct reqtree *tree, int layer)
 {
   int layer1_size = tree->layer_size[layer];
   int layer2_size = tree->layer_size[layer + 1];
-  std::vector<int> X;
-  X.reserve(layer2_size);
+  std::vector<int> fenwick(layer2_size + 1, 0);
   int i, j, k;
+  int seen = 0;
   int sum = 0;
 
-  for (i = 0; i < layer2_size; i++) {
-    X[i] = 0;
-  }
-
   for (i = 0; i < layer1_size; i++) {
     struct tree_node *node = tree->layers[layer][i];
 
+    /* Edges from the same node don't cross. Count the earlier edges
+     * ending below each edge first, then add the edges of the node. */
     for (j = 0; j < node->nprovide; j++) {
-      sum += X[node->provide[j]->order];
+      int below = 0;
+
+      for (k = node->provide[j]->order + 1; k > 0; k -= k & -k) {
+        below += fenwick[k];
+      }
+      sum += seen - below;
     }
     for (j = 0; j < node->nprovide; j++) {
-      for (k = 0; k < node->provide[j]->order; k++) {
-        X[k]++;
+      for (k = node->provide[j]->order + 1; k <= layer2_size; k += k & -k) {
+        fenwick[k]++;
       }
     }
+    seen += node->nprovide;
+  }
+
+  return sum;
+}
+
+/**
+   Calculate number of edge crossings in the whole tree
+ */
+static int count_all_crossings(struct reqtree *tree)
+{
+  int layer;
+  int sum = 0;
+
+  for (layer = 0; layer < tree->num_layers - 1; layer++) {
+    sum += count_crossings(tree, layer);
   }
 
   return sum;
@@ -729,56 +759,143 @@ static void swap(struct reqtree *tree, int layer, int order1, int order2)
 }
 
 /**
-   Try to reduce the number of crossings by swapping two nodes and checking
-   if it improves the situation.
+   Number of crossings between the edges of two nodes of the same layer
+   when node1 is placed above node2.
  */
-static void improve(struct reqtree *tree)
+static int pair_crossings(const struct tree_node *node1,
+                          const struct tree_node *node2)
+{
+  int i, j;
+  int sum = 0;
+
+  for (i = 0; i < node1->nrequire; i++) {
+    for (j = 0; j < node2->nrequire; j++) {
+      if (node1->require[i]->order > node2->require[j]->order) {
+        sum++;
+      }
+    }
+  }
+  for (i = 0; i < node1->nprovide; i++) {
+    for (j = 0; j < node2->nprovide; j++) {
+      if (node1->provide[i]->order > node2->provide[j]->order) {
+        sum++;
+      }
+    }
+  }
+
+  return sum;
+}
+
+/**
+   Remember the current order of all nodes.
+ */
+static void save_orders(const struct reqtree *tree, std::vector<int> &orders)
 {
-  std::vector<int> crossings;
-  crossings.reserve(tree->num_layers - 1);
-  int i, x1, x2, layer;
+  int i;
 
-  for (i = 0; i < tree->num_layers - 1; i++) {
-    crossings[i] = count_crossings(tree, i);
+  orders.resize(tree->num_nodes);
+  for (i = 0; i < tree->num_nodes; i++) {
+    orders[i] = tree->nodes[i]->order;
   }
+}
 
-  for (layer = 0; layer < tree->num_layers; layer++) {
-    int layer_size = tree->layer_size[layer];
-    int layer_sum = 0;
+/**
+   Put the nodes back in the order saved by save_orders().
+ */
+static void restore_orders(struct reqtree *tree,
+                           const std::vector<int> &orders)
+{
+  int i;
+
+  for (i = 0; i < tree->num_nodes; i++) {
+    struct tree_node *node = tree->nodes[i];
+
+    node->order = orders[i];
+    tree->layers[node->layer][node->order] = node;
+  }
+}
+
+/**
+   Reduce the number of crossings. Layers are first sorted by barycentres
+   in alternating downward and upward sweeps, keeping the best ordering
+   seen. Adjacent nodes are then swapped while that removes crossings,
+   within a bounded number of swaps.
+ */
+static void improve(struct reqtree *tree)
+{
+  std::vector<int> best_orders;
+  int best = count_all_crossings(tree);
+  int budget = 50 * tree->num_nodes;
+  int i, layer;
+  bool changed;
+
+  save_orders(tree, best_orders);
+
+  for (i = 0; i < 20 && best > 0; i++) {
+    int crossings;
 
-    if (layer > 0) {
-      layer_sum += crossings[layer - 1];
+    for (layer = 1; layer < tree->num_layers; layer++) {
+      barycentric_sort(tree, layer, false);
     }
-    if (layer < tree->num_layers - 1) {
-      layer_sum += crossings[layer];
+    for (layer = tree->num_layers - 2; layer >= 0; layer--) {
+      barycentric_sort(tree, layer, true);
     }
 
-    for (x1 = 0; x1 < layer_size; x1++) {
-      for (x2 = x1 + 1; x2 < layer_size; x2++) {
-        int new_crossings = 0;
-        int new_crossings_before = 0;
-
-        swap(tree, layer, x1, x2);
-        if (layer > 0) {
-          new_crossings_before += count_crossings(tree, layer - 1);
-        }
-        if (layer < tree->num_layers - 1) {
-          new_crossings += count_crossings(tree, layer);
-        }
-        if (new_crossings + new_crossings_before > layer_sum) {
-          swap(tree, layer, x1, x2);
-        } else {
-          layer_sum = new_crossings + new_crossings_before;
-          if (layer > 0) {
-            crossings[layer - 1] = new_crossings_before;
-          }
-          if (layer < tree->num_layers - 1) {
-            crossings[layer] = new_crossings;
-          }
+    crossings = count_all_crossings(tree);
+    if (crossings < best) {
+      best = crossings;
+      save_orders(tree, best_orders);
+    } else {
+      break;
+    }
+  }
+  restore_orders(tree, best_orders);
+
+  do {
+    changed = false;
+    for (layer = 0; layer < tree->num_layers && budget > 0; layer++) {
+      for (i = 0; i < tree->layer_size[layer] - 1 && budget > 0; i++) {
+        struct tree_node *node1 = tree->layers[layer][i];
+        struct tree_node *node2 = tree->layers[layer][i + 1];
+
+        if (pair_crossings(node2, node1) < pair_crossings(node1, node2)) {
+          swap(tree, layer, i, i + 1);
+          changed = true;
+          budget--;
         }
       }
     }
+  } while (changed && budget > 0);
+}
+
+/**
+   Layouts computed by create_reqtree(), indexed by the signature of the
+   tree they were computed for. The signature lists the techs on the tree
+   and their requirements, so it changes with the ruleset and, when not
+   all techs are shown, with what the player can reach.
+ */
+static QHash<QByteArray, std::vector<int>> layout_cache;
+
+/**
+   Compute the signature of a tree created by create_dummy_reqtree().
+ */
+static QByteArray reqtree_signature(const struct reqtree *tree)
+{
+  QByteArray signature;
+  int i, j;
+
+  for (i = 0; i < tree->num_nodes; i++) {
+    const struct tree_node *node = tree->nodes[i];
+
+    signature.append(QByteArray::number(node->tech));
+    for (j = 0; j < node->nrequire; j++) {
+      signature.append(',');
+      signature.append(QByteArray::number(node->require[j]->tech));
+    }
+    signature.append(';');
   }
+
+  return signature;
 }
 
 /**
@@ -790,24 +907,30 @@ static void improve(struct reqtree *tree)
 struct reqtree *create_reqtree(struct player *pplayer, bool show_all)
 {
   struct reqtree *tree1, *tree2;
-  int i, j;
+  QByteArray signature;
+  int i;
 
   tree1 = create_dummy_reqtree(pplayer, show_all);
+  signature = reqtree_signature(tree1);
   longest_path_layering(tree1);
   tree2 = add_dummy_nodes(tree1);
   destroy_reqtree(tree1);
   set_layers(tree2);
 
-  // It's good heuristics for beginning
-  for (j = 0; j < 20; j++) {
+  if (layout_cache.contains(signature)) {
+    restore_orders(tree2, layout_cache.value(signature));
+  } else {
+    // It's good heuristics for beginning
     for (i = 0; i < tree2->num_layers; i++) {
-      barycentric_sort(tree2, i);
+      barycentric_sort(tree2, i, false);
     }
-  }
 
-  // Now burn some CPU
-  for (j = 0; j < 20; j++) {
     improve(tree2);
+
+    if (layout_cache.size() >= 8) {
+      layout_cache.clear();
+    }
+    save_orders(tree2, layout_cache[signature]);
   }
 
   calculate_diagram_layout(tree2);
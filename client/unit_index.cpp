@@ -0,0 +1,167 @@
+/*__            ___                 ***************************************
+/   \          /   \          Copyright (c) 1996-2020 Freeciv21 and Freeciv
+\_   \        /  __/          contributors. This file is part of Freeciv21.
+ _\   \      /  /__     Freeciv21 is free software: you can redistribute it
+ \___  \____/   __/    and/or modify it under the terms of the GNU  General
+     \_       _/          Public License  as published by the Free Software
+       | @ @  \_               Foundation, either version 3 of the  License,
+       |                              or (at your option) any later version.
+     _/     /\                  You should have received  a copy of the GNU
+    /o)  (o/\ \_                General Public License along with Freeciv21.
+    \_____/ /                     If not, see https://www.gnu.org/licenses/.
+      \____/        ********************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+// std
+#include <algorithm>
+
+// Qt
+#include <QHash>
+#include <QPair>
+
+// common
+#include "game.h"
+#include "unit.h"
+
+#include "unit_index.h"
+
+namespace {
+
+// The keys a unit is currently filed under.
+struct indexed_unit {
+  struct unit *punit;
+  int homecity;
+  const struct player *owner;
+  const struct unit_type *utype;
+};
+
+typedef QPair<const struct player *, const struct unit_type *> type_key;
+
+struct unit_index {
+  QHash<int, indexed_unit> units;
+  QHash<int, std::vector<struct unit *>> by_homecity;
+  QHash<type_key, std::vector<struct unit *>> by_type;
+};
+
+Q_GLOBAL_STATIC(unit_index, uindex)
+Q_GLOBAL_STATIC(std::vector<struct unit *>, no_units)
+
+/**
+   Remove punit from the bucket stored under key, dropping the bucket when
+   it becomes empty.
+ */
+template <typename Key>
+void bucket_remove(QHash<Key, std::vector<struct unit *>> &hash,
+                   const Key &key, struct unit *punit)
+{
+  auto it = hash.find(key);
+
+  if (it == hash.end()) {
+    return;
+  }
+  it->erase(std::remove(it->begin(), it->end(), punit), it->end());
+  if (it->empty()) {
+    hash.erase(it);
+  }
+}
+
+/**
+   Remove an indexed unit from all buckets.
+ */
+void unfile_unit(const indexed_unit &entry)
+{
+  if (entry.homecity != IDENTITY_NUMBER_ZERO) {
+    bucket_remove(uindex->by_homecity, entry.homecity, entry.punit);
+  }
+  bucket_remove(uindex->by_type, type_key(entry.owner, entry.utype),
+                entry.punit);
+}
+
+} // anonymous namespace
+
+/**
+   Start tracking units. Removal is hooked into game_remove_unit(), which
+   every unit leaving the client's world goes through.
+ */
+void unit_index_init()
+{
+  unit_index_free();
+  game.callbacks.unit_deallocate = unit_index_remove;
+}
+
+/**
+   Forget all indexed units.
+ */
+void unit_index_free()
+{
+  uindex->units.clear();
+  uindex->by_homecity.clear();
+  uindex->by_type.clear();
+}
+
+/**
+   File a unit under its current homecity, owner and type. Called for new
+   units and after every unit update; does nothing when none of the keys
+   changed.
+ */
+void unit_index_update(struct unit *punit)
+{
+  auto it = uindex->units.find(punit->id);
+
+  if (it != uindex->units.end()) {
+    if (it->punit == punit && it->homecity == punit->homecity
+        && it->owner == unit_owner(punit)
+        && it->utype == unit_type_get(punit)) {
+      return;
+    }
+    unfile_unit(*it);
+  }
+
+  indexed_unit entry = {punit, punit->homecity, unit_owner(punit),
+                        unit_type_get(punit)};
+
+  uindex->units.insert(punit->id, entry);
+  if (entry.homecity != IDENTITY_NUMBER_ZERO) {
+    uindex->by_homecity[entry.homecity].push_back(punit);
+  }
+  uindex->by_type[type_key(entry.owner, entry.utype)].push_back(punit);
+}
+
+/**
+   Stop tracking the unit with the given id.
+ */
+void unit_index_remove(int unit_id)
+{
+  auto it = uindex->units.find(unit_id);
+
+  if (it != uindex->units.end()) {
+    unfile_unit(*it);
+    uindex->units.erase(it);
+  }
+}
+
+/**
+   Returns the known units whose homecity is city_id. The city itself does
+   not need to be known yet.
+ */
+const std::vector<struct unit *> &units_by_homecity(int city_id)
+{
+  auto it = uindex->by_homecity.constFind(city_id);
+
+  return it == uindex->by_homecity.constEnd() ? *no_units : *it;
+}
+
+/**
+   Returns the known units of the given type owned by pplayer.
+ */
+const std::vector<struct unit *> &
+player_units_by_type(const struct player *pplayer,
+                     const struct unit_type *ptype)
+{
+  auto it = uindex->by_type.constFind(type_key(pplayer, ptype));
+
+  return it == uindex->by_type.constEnd() ? *no_units : *it;
+}
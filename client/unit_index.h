@@ -0,0 +1,36 @@
+/*__            ___                 ***************************************
+/   \          /   \          Copyright (c) 1996-2020 Freeciv21 and Freeciv
+\_   \        /  __/          contributors. This file is part of Freeciv21.
+ _\   \      /  /__     Freeciv21 is free software: you can redistribute it
+ \___  \____/   __/    and/or modify it under the terms of the GNU  General
+     \_       _/          Public License  as published by the Free Software
+       | @ @  \_               Foundation, either version 3 of the  License,
+       |                              or (at your option) any later version.
+     _/     /\                  You should have received  a copy of the GNU
+    /o)  (o/\ \_                General Public License along with Freeciv21.
+    \_____/ /                     If not, see https://www.gnu.org/licenses/.
+      \____/        ********************************************************/
+#pragma once
+
+// std
+#include <vector>
+
+struct player;
+struct unit;
+struct unit_type;
+
+/* Reverse indexes over the units known to the client. They are kept up to
+ * date by the unit packet handlers and game_remove_unit(), so lookups cost
+ * O(result) instead of a scan of every unit list. Units appear in the
+ * order the client first learned about them. */
+
+void unit_index_init();
+void unit_index_free();
+
+void unit_index_update(struct unit *punit);
+void unit_index_remove(int unit_id);
+
+const std::vector<struct unit *> &units_by_homecity(int city_id);
+const std::vector<struct unit *> &
+player_units_by_type(const struct player *pplayer,
+                     const struct unit_type *ptype);
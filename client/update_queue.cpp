@@ -16,6 +16,7 @@
 #endif
 
 // Qt
+#include <QSet>
 #include <QUrl>
 
 // utility
@@ -25,6 +26,7 @@
 // common
 #include "city.h"
 #include "connection.h"
+#include "game.h"
 #include "player.h"
 
 /* client/include */
@@ -49,6 +51,9 @@
 
 update_queue *update_queue::m_instance = nullptr;
 
+// Ids of the cities with pending need_updates.
+Q_GLOBAL_STATIC(QSet<int>, cities_to_update)
+
 // returns instance of queue
 update_queue *update_queue::uq()
 {
@@ -139,6 +144,7 @@ void update_queue::init()
   }
   wq_processing_started.clear();
   wq_processing_finished.clear();
+  cities_to_update->clear();
 }
 
 update_queue::~update_queue() { init(); }
@@ -190,6 +196,12 @@ void update_queue::force_thaw(void)
 
 bool update_queue::is_frozen(void) const { return (0 < frozen_level); }
 
+// Returns how many updates were requested, including merged ones.
+int update_queue::num_requested() const { return requested_count; }
+
+// Returns how many updates were run.
+int update_queue::num_run() const { return run_count; }
+
 // Moves the instances waiting to the request_id to the callback queue.
 void update_queue::processing_started(int request_id)
 {
@@ -221,23 +233,24 @@ void update_queue::update_unqueue()
     auto uq_data = pair.second;
     callback(uq_data->data);
     data_destroy(uq_data);
+    run_count++;
   }
 }
 
-// Add a callback to the update queue. NB: you can only set a callback
-// once. Setting a callback twice will put new callback at end.
+// Add a callback to the update queue. NB: a callback is only queued once
+// for the same data. Setting it twice will put the new one at the end.
+// Callbacks with different data are all kept, in order.
 void update_queue::push(uq_callback_t callback,
                         struct update_queue_data *uq_data)
 {
-  struct update_queue_data *uqr_data = nullptr;
-  for (auto p : qAsConst(queue)) {
-    if (p.first == callback)
-      uqr_data = p.second;
-  }
-  auto pr = qMakePair(callback, uqr_data);
-  queue.removeAll(pr);
-  if (uqr_data) {
-    data_destroy(uqr_data);
+  requested_count++;
+  for (auto it = queue.begin(); it != queue.end(); ++it) {
+    if (it->first == callback && it->second->data == uq_data->data) {
+      // The new entry owns the same data, only drop the old wrapper.
+      delete it->second;
+      queue.erase(it);
+      break;
+    }
   }
   queue.enqueue(qMakePair(callback, uq_data));
 
@@ -248,14 +261,14 @@ void update_queue::push(uq_callback_t callback,
 }
 
 // Add a callback to the update queue. NB: you can only set a callback
-// once. Setting a callback twice will overwrite the previous.
+// once for the same data. Setting it twice will overwrite the previous.
 void update_queue::add(uq_callback_t callback, void *data)
 {
   push(callback, data_new(data, NULL));
 }
 
 // Add a callback to the update queue. NB: you can only set a callback
-// once. Setting a callback twice will overwrite the previous.
+// once for the same data. Setting it twice will overwrite the previous.
 void update_queue::add_full(uq_callback_t callback, void *data,
                             uq_free_fn_t free_data_func)
 {
@@ -442,8 +455,16 @@ static void cities_update_callback(void *data)
   }
 #endif // FREECIV_DEBUG
 
-  cities_iterate(pcity)
-  {
+  const QSet<int> city_ids = *cities_to_update;
+
+  cities_to_update->clear();
+  for (int city_id : city_ids) {
+    struct city *pcity = game_city_by_number(city_id);
+
+    if (NULL == pcity) {
+      continue; // Removed in the meantime.
+    }
+
     enum city_updates need_update = pcity->client.need_updates;
 
     if (CU_NO_UPDATE == need_update) {
@@ -465,7 +486,6 @@ static void cities_update_callback(void *data)
     }
 #endif // FREECIV_DEBUG
   }
-  cities_iterate_end;
 #undef NEED_UPDATE
 }
 
@@ -475,6 +495,7 @@ void popup_city_dialog(struct city *pcity)
   pcity->client.need_updates =
       static_cast<city_updates>(static_cast<int>(pcity->client.need_updates)
                                 | static_cast<int>(CU_POPUP_DIALOG));
+  cities_to_update->insert(pcity->id);
   update_queue::uq()->add(cities_update_callback, NULL);
 }
 
@@ -484,6 +505,7 @@ void refresh_city_dialog(struct city *pcity)
   pcity->client.need_updates =
       static_cast<city_updates>(static_cast<int>(pcity->client.need_updates)
                                 | static_cast<int>(CU_UPDATE_DIALOG));
+  cities_to_update->insert(pcity->id);
   update_queue::uq()->add(cities_update_callback, NULL);
 }
 
@@ -493,6 +515,7 @@ void city_report_dialog_update_city(struct city *pcity)
   pcity->client.need_updates =
       static_cast<city_updates>(static_cast<int>(pcity->client.need_updates)
                                 | static_cast<int>(CU_UPDATE_REPORT));
+  cities_to_update->insert(pcity->id);
   update_queue::uq()->add(cities_update_callback, NULL);
 }
 
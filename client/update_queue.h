@@ -43,6 +43,8 @@ class update_queue {
   waitingQueue wq_processing_finished;
   int frozen_level = {0};
   bool has_idle_cb = {false};
+  int requested_count = {0};
+  int run_count = {0};
 
 public:
   static update_queue *uq();
@@ -66,11 +68,13 @@ public:
                                        void *data, uq_free_fn_t free_fn);
   void connect_processing_finished_full(int request_id, uq_callback_t cb,
                                         void *data, uq_free_fn_t free_func);
+  void freeze();
+  void thaw();
+  int num_requested() const;
+  int num_run() const;
 
 private:
   update_queue() = default;
-  void freeze();
-  void thaw();
   void force_thaw();
   bool is_frozen() const;
   struct update_queue_data *data_new(void *data, uq_free_fn_t free_fn);
@@ -24,6 +24,18 @@ cmake_dependent_option(
   FREECIV_ENABLE_RULEUP
   "Build the ruleset updater"
   ON FREECIV_ENABLE_TOOLS OFF)
+cmake_dependent_option(
+  FREECIV_ENABLE_MAPGEN_BENCH
+  "Build the map generator benchmark"
+  OFF FREECIV_ENABLE_TOOLS OFF)
+cmake_dependent_option(
+  FREECIV_ENABLE_MAP_ITER_BENCH
+  "Build the map iteration benchmark"
+  OFF FREECIV_ENABLE_TOOLS OFF)
+cmake_dependent_option(
+  FREECIV_ENABLE_PACKET_REPLAY
+  "Build the client packet replay benchmark"
+  OFF "FREECIV_ENABLE_TOOLS;FREECIV_ENABLE_CLIENT" OFF)
 
 option(FREECIV_ENABLE_NLS "Enable internationalization" ON)
 
@@ -49,6 +61,7 @@ endif()
 if (FREECIV_ENABLE_SERVER
     OR FREECIV_ENABLE_CIVMANUAL
     OR FREECIV_ENABLE_RULEDIT
-    OR FREECIV_ENABLE_RULEUP)
+    OR FREECIV_ENABLE_RULEUP
+    OR FREECIV_ENABLE_MAPGEN_BENCH)
   set(FREECIV_BUILD_LIBSERVER TRUE)
 endif()
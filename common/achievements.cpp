@@ -180,6 +180,68 @@ struct player *achievement_plr(struct achievement *ach,
   return credited;
 }
 
+/**
+   Returns whether the tile is known by the player, on the server or on
+   the client.
+ */
+static bool achievement_tile_known(const struct player *pplayer,
+                                   const struct tile *ptile)
+{
+  if (is_server()) {
+    return pplayer->tile_known->at(tile_index(ptile));
+  } else {
+    // Client
+    return ptile->terrain != T_UNKNOWN;
+  }
+}
+
+/**
+   Count the tiles known by the player by scanning the whole map. The
+   server keeps this number in pplayer->server.known_tiles; this is used
+   by the client and to verify the server counter.
+ */
+int achievement_scan_known_tiles(const struct player *pplayer)
+{
+  int known = 0;
+
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    if (achievement_tile_known(pplayer, ptile)) {
+      known++;
+    }
+  }
+  whole_map_iterate_end;
+
+  return known;
+}
+
+/**
+   Count the continents where the player knows at least one tile by
+   scanning the whole map. The server keeps this number in
+   pplayer->server.known_continents; this is used by the client and to
+   verify the server counter.
+ */
+int achievement_scan_known_continents(const struct player *pplayer)
+{
+  std::vector<bool> seen(wld.map.num_continents);
+  int count = 0;
+
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    /* FIXME: This makes the assumption that fogged tiles belonged
+     *        to their current continent when they were last seen. */
+    if (ptile->continent > 0 && ptile->continent <= wld.map.num_continents
+        && !seen[ptile->continent - 1]
+        && achievement_tile_known(pplayer, ptile)) {
+      seen[ptile->continent - 1] = true;
+      count++;
+    }
+  }
+  whole_map_iterate_end;
+
+  return count;
+}
+
 /**
    Check if player has now achieved the achievement.
  */
@@ -198,8 +260,6 @@ bool achievement_check(struct achievement *ach, struct player *pplayer)
     int max_unknown;
     int required;
     int total;
-    int known = 0;
-    int unknown = 0;
 
     /* We calculate max_unknown first for getting the
      * rounding correctly.
@@ -212,37 +272,12 @@ bool achievement_check(struct achievement *ach, struct player *pplayer)
     max_unknown = (total * (100 - ach->value)) / 100;
     required = total - max_unknown;
 
-    whole_map_iterate(&(wld.map), ptile)
-    {
-      bool this_is_known = false;
-
-      if (is_server()) {
-        if (pplayer->tile_known->at(tile_index(ptile))) {
-          this_is_known = true;
-        }
-      } else {
-        // Client
-        if (ptile->terrain != T_UNKNOWN) {
-          this_is_known = true;
-        }
-      }
-
-      if (this_is_known) {
-        known++;
-        if (known >= required) {
-          return true;
-        }
-      } else {
-        unknown++;
-        if (unknown >= max_unknown) {
-          return false;
-        }
-      }
+    if (is_server()) {
+      return pplayer->server.known_tiles >= required;
+    } else {
+      return achievement_scan_known_tiles(pplayer) >= required;
     }
-    whole_map_iterate_end;
   }
-
-    return false;
   case ACHIEVEMENT_MULTICULTURAL: {
     bv_player seen_citizens;
     int count = 0;
@@ -303,38 +338,16 @@ bool achievement_check(struct achievement *ach, struct player *pplayer)
   case ACHIEVEMENT_LITERATE:
     return get_literacy(pplayer) >= ach->value;
   case ACHIEVEMENT_LAND_AHOY: {
-    std::vector<bool> seen(wld.map.num_continents);
-    int count = 0;
-
-    whole_map_iterate(&(wld.map), ptile)
-    {
-      bool this_is_known = false;
-
-      if (is_server()) {
-        if (pplayer->tile_known->at(tile_index(ptile))) {
-          this_is_known = true;
-        }
-      } else {
-        // Client
-        if (ptile->terrain != T_UNKNOWN) {
-          this_is_known = true;
-        }
-      }
+    int count;
 
-      if (this_is_known) {
-        /* FIXME: This makes the assumption that fogged tiles belonged
-         *        to their current continent when they were last seen. */
-        if (ptile->continent > 0 && !seen[ptile->continent - 1]) {
-          if (++count >= ach->value) {
-            return true;
-          }
-          seen[ptile->continent - 1] = true;
-        }
-      }
+    if (is_server()) {
+      count = pplayer->server.known_continents;
+    } else {
+      count = achievement_scan_known_continents(pplayer);
     }
-    whole_map_iterate_end;
 
-    return false;
+    // At least one continent must be known, even if value is zero.
+    return count > 0 && count >= ach->value;
   }
   case ACHIEVEMENT_COUNT:
     break;
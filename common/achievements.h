@@ -47,6 +47,8 @@ struct achievement *achievement_by_rule_name(const char *name);
 struct player *achievement_plr(struct achievement *ach,
                                struct player_list *achievers);
 bool achievement_check(struct achievement *ach, struct player *pplayer);
+int achievement_scan_known_tiles(const struct player *pplayer);
+int achievement_scan_known_continents(const struct player *pplayer);
 
 const char *achievement_first_msg(struct achievement *pach);
 const char *achievement_later_msg(struct achievement *pach);
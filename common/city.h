@@ -66,6 +66,9 @@ enum production_class_type {
 // Maximum diameter of the workable city area.
 #define CITY_MAP_MAX_SIZE (CITY_MAP_MAX_RADIUS * 2 + 1)
 
+// Upper bound of the number of tiles in a city map.
+#define MAX_CITY_TILES (CITY_MAP_MAX_SIZE * CITY_MAP_MAX_SIZE)
+
 #define INCITE_IMPOSSIBLE_COST (1000 * 1000 * 1000)
 
 /*
@@ -138,6 +138,8 @@ void map_init(struct civ_map *imap, bool server_side)
   imap->num_continents = 0;
   imap->num_oceans = 0;
   imap->tiles = NULL;
+  imap->neighbour_indices = NULL;
+  memset(imap->extra_tile_count, 0, sizeof(imap->extra_tile_count));
   imap->startpos_table = NULL;
   imap->iterate_outwards_indices = NULL;
 
@@ -272,6 +274,27 @@ static void generate_map_indices()
   wld.map.num_iterate_outwards_indices = tiles;
 }
 
+/**
+   Fill the neighbour table of the main map, so that adjacent tiles can be
+   looked up instead of being computed with wrapping and normalization.
+ */
+static void generate_map_neighbours()
+{
+  fc_assert(NULL == wld.map.neighbour_indices);
+  wld.map.neighbour_indices = new int[MAP_INDEX_SIZE * 8];
+
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    for (int dir = 0; dir < 8; dir++) {
+      struct tile *adjc = mapstep(&(wld.map), ptile, direction8(dir));
+
+      wld.map.neighbour_indices[tile_index(ptile) * 8 + dir] =
+          (NULL != adjc ? tile_index(adjc) : -1);
+    }
+  }
+  whole_map_iterate_end;
+}
+
 /**
    map_init_topology needs to be called after map.topology_id is changed.
 
@@ -489,6 +512,7 @@ void map_allocate(struct civ_map *amap)
   whole_map_iterate_end;
   NFC_FREE(amap->startpos_table);
   amap->startpos_table = new QHash<struct tile *, struct startpos *>;
+  memset(amap->extra_tile_count, 0, sizeof(amap->extra_tile_count));
 }
 
 /**
@@ -499,6 +523,7 @@ void main_map_allocate()
   map_allocate(&(wld.map));
   generate_city_map_indices();
   generate_map_indices();
+  generate_map_neighbours();
   CALL_FUNC_EACH_AI(map_alloc);
 }
 
@@ -523,6 +548,7 @@ void map_free(struct civ_map *fmap)
     }
 
     FCPP_FREE(fmap->iterate_outwards_indices);
+    FCPP_FREE(fmap->neighbour_indices);
   }
 }
 
@@ -531,6 +557,13 @@ void map_free(struct civ_map *fmap)
  */
 void main_map_free()
 {
+  players_iterate(pplayer)
+  {
+    pplayer->owned_tiles.clear();
+    pplayer->owned_extras.clear();
+  }
+  players_iterate_end;
+
   map_free(&(wld.map));
   CALL_FUNC_EACH_AI(map_free);
 }
@@ -978,6 +1011,37 @@ struct tile *nearest_real_tile(const struct civ_map *nmap, int x, int y)
  */
 int map_num_tiles() { return wld.map.xsize * wld.map.ysize; }
 
+/**
+   Recount the tiles having each extra. Needed after the extras of the
+   tiles have been written directly rather than through tile_add_extra()
+   and tile_remove_extra(), as the map generator and the savegame loader
+   do.
+ */
+void map_count_extras(struct civ_map *nmap)
+{
+  memset(nmap->extra_tile_count, 0, sizeof(nmap->extra_tile_count));
+
+  whole_map_iterate(nmap, ptile)
+  {
+    extra_type_iterate(pextra)
+    {
+      if (tile_has_extra(ptile, pextra)) {
+        nmap->extra_tile_count[extra_index(pextra)]++;
+      }
+    }
+    extra_type_iterate_end;
+  }
+  whole_map_iterate_end;
+}
+
+/**
+   Returns the number of tiles of the main map having the extra.
+ */
+int map_extra_tile_count(const struct extra_type *pextra)
+{
+  return wld.map.extra_tile_count[extra_index(pextra)];
+}
+
 /**
    Finds the difference between the two (unnormalized) positions, in
    cartesian (map) coordinates.  Most callers should use map_distance_vector
@@ -216,6 +216,8 @@ void base_map_distance_vector(int *dx, int *dy, int x0, int y0, int x1,
 void map_distance_vector(int *dx, int *dy, const struct tile *ptile0,
                          const struct tile *ptile1);
 int map_num_tiles();
+void map_count_extras(struct civ_map *nmap);
+int map_extra_tile_count(const struct extra_type *pextra);
 #define map_size_checked() MAX(map_num_tiles() / 1000, 1)
 
 struct tile *rand_neighbour(const struct civ_map *nmap,
@@ -285,6 +287,8 @@ extern struct terrain_misc terrain_control;
     const struct tile *_tile##_start = (start_tile);                        \
     int _tile##_max = (max_dist);                                           \
     int _tile##_index = 0;                                                  \
+    const bool _tile##_inner =                                              \
+        is_inner_tile(nmap, _tile##_start, _tile##_max);                    \
     index_to_map_pos(&_start##_x, &_start##_y, tile_index(_tile##_start));  \
     for (; _tile##_index < wld.map.num_iterate_outwards_indices;            \
          _tile##_index++) {                                                 \
@@ -294,11 +298,16 @@ extern struct terrain_misc terrain_control;
       }                                                                     \
       _x = wld.map.iterate_outwards_indices[_tile##_index].dx;              \
       _y = wld.map.iterate_outwards_indices[_tile##_index].dy;              \
-      _tile##_x = _x + _start##_x;                                          \
-      _tile##_y = _y + _start##_y;                                          \
-      _tile = map_pos_to_tile(nmap, _tile##_x, _tile##_y);                  \
-      if (NULL == _tile) {                                                  \
-        continue;                                                           \
+      if (_tile##_inner) {                                                  \
+        _tile = (nmap)->tiles + tile_index(_tile##_start)                   \
+                + _y * wld.map.xsize + _x;                                  \
+      } else {                                                              \
+        _tile##_x = _x + _start##_x;                                        \
+        _tile##_y = _y + _start##_y;                                        \
+        _tile = map_pos_to_tile(nmap, _tile##_x, _tile##_y);                \
+        if (NULL == _tile) {                                                \
+          continue;                                                         \
+        }                                                                   \
       }
 
 #define iterate_outward_dxy_end                                             \
@@ -446,17 +455,12 @@ extern struct terrain_misc terrain_control;
                              dircount)                                      \
   {                                                                         \
     enum direction8 _dir;                                                   \
-    int _tile##_x, _tile##_y, _tile##_cx, _tile##_cy;                       \
     struct tile *_tile;                                                     \
     const struct tile *_tile##_center = (center_tile);                      \
     int _tile##_index = 0;                                                  \
-    index_to_map_pos(&_tile##_cx, &_tile##_cy, tile_index(_tile##_center)); \
     for (; _tile##_index < (dircount); _tile##_index++) {                   \
       _dir = dirlist[_tile##_index];                                        \
-      DIRSTEP(_tile##_x, _tile##_y, _dir);                                  \
-      _tile##_x += _tile##_cx;                                              \
-      _tile##_y += _tile##_cy;                                              \
-      _tile = map_pos_to_tile(nmap, _tile##_x, _tile##_y);                  \
+      _tile = map_neighbour_tile(nmap, _tile##_center, _dir);               \
       if (NULL == _tile) {                                                  \
         continue;                                                           \
       }
@@ -664,5 +668,36 @@ static inline bool is_border_tile(const struct tile *ptile, int dist)
           || nat_y >= wld.map.ysize - ydist);
 }
 
+/****************************************************************************
+  An "inner position" of a plain (non-iso, non-hex) map is a position whose
+  neighbours within real map distance dist are all normal, and can be
+  reached by adding their offset to its index.
+****************************************************************************/
+static inline bool is_inner_tile(const struct civ_map *nmap,
+                                 const struct tile *ptile, int dist)
+{
+  return (!MAP_IS_ISOMETRIC && NULL != nmap->tiles
+          && tile_index(ptile) != TILE_INDEX_NONE
+          && !is_border_tile(ptile, dist));
+}
+
+/****************************************************************************
+  Return the tile adjacent to ptile in the given direction, or NULL. This
+  is a lookup in the neighbour table of the map when it has one.
+****************************************************************************/
+static inline struct tile *map_neighbour_tile(const struct civ_map *nmap,
+                                              const struct tile *ptile,
+                                              enum direction8 dir)
+{
+  if (NULL != nmap->neighbour_indices
+      && tile_index(ptile) != TILE_INDEX_NONE) {
+    int nindex = nmap->neighbour_indices[tile_index(ptile) * 8 + dir];
+
+    return (0 <= nindex ? nmap->tiles + nindex : NULL);
+  }
+
+  return mapstep(nmap, ptile, dir);
+}
+
 enum direction8 rand_direction();
 enum direction8 opposite_direction(enum direction8 dir);
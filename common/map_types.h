@@ -76,6 +76,11 @@ struct civ_map {
   int num_continents;
   int num_oceans; // not updated at the client
   struct tile *tiles;
+  /* Index of the adjacent tile in each direction8, or -1 (8 per tile).
+   * Only allocated for the main map. */
+  int *neighbour_indices;
+  // Number of main map tiles having each extra (not kept by the client)
+  int extra_tile_count[MAX_EXTRA_TYPES];
   QHash<struct tile *, struct startpos *> *startpos_table;
 
   union {
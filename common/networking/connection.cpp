@@ -665,15 +665,6 @@ void conn_list_compression_freeze(const struct conn_list *pconn_list)
   conn_list_iterate_end;
 }
 
-/**
-   Thaw a connection list.
- */
-void conn_list_compression_thaw(const struct conn_list *pconn_list)
-{
-  conn_list_iterate(pconn_list, pconn) { conn_compression_thaw(pconn); }
-  conn_list_iterate_end;
-}
-
 /**
    Returns TRUE if the given connection is attached to a player which it
    also controls (i.e. not a player observer).
@@ -19,6 +19,12 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <vector>
+
+// Qt
+#include <QRunnable>
+#include <QThreadPool>
+#include <QVector>
 
 // utility
 #include "capability.h"
@@ -90,75 +96,153 @@ static inline int get_compression_level()
 }
 
 /**
-   Send all waiting data. Return TRUE on success.
+   Waiting data of a connection, compressed and framed the way it has to be
+   sent on the wire.
  */
-static bool conn_compression_flush(struct connection *pconn)
+struct compressed_data {
+  QByteArray bytes;
+  size_t size = 0;
+  uLongf compressed_size = 0;
+  bool compressed = false;
+  bool ok = false;
+};
+
+/**
+   Compress size bytes of waiting data. If compressing is worth it, the
+   result holds the whole compressed packet, header included. This only
+   reads its arguments, so it may run on a network worker thread.
+ */
+static void compress_data(const unsigned char *data, size_t size,
+                          int compression_level, struct compressed_data *out)
 {
-  int compression_level = get_compression_level();
-  uLongf compressed_size = 12 + 1.001 * pconn->compression.queue.size;
+  uLongf compressed_size = 12 + 1.001 * size;
   int error;
   QScopedArrayPointer<Bytef> compressed(new Bytef[compressed_size]);
   bool jumbo;
   unsigned long compressed_packet_len;
 
-  error = compress2(compressed.data(), &compressed_size,
-                    pconn->compression.queue.p,
-                    pconn->compression.queue.size, compression_level);
-  fc_assert_ret_val(error == Z_OK, false);
-
-  /* Compression signalling currently assumes a 2-byte packet length; if that
-   * changes, the protocol should probably be changed */
-  fc_assert_ret_val(
-      data_type_size(data_type(pconn->packet_header.length)) == 2, false);
+  out->size = size;
+  error = compress2(compressed.data(), &compressed_size, data, size,
+                    compression_level);
+  fc_assert_ret(error == Z_OK);
+  out->ok = true;
 
   // Include normal length field in decision
   jumbo = (compressed_size + 2 >= JUMBO_BORDER);
 
   compressed_packet_len = compressed_size + (jumbo ? 6 : 2);
-  if (compressed_packet_len < pconn->compression.queue.size) {
+  out->compressed_size = compressed_packet_len;
+  if (compressed_packet_len < size) {
     struct raw_data_out dout;
 
-    log_compress("COMPRESS: compressed %lu bytes to %ld (level %d)",
-                 (unsigned long) pconn->compression.queue.size,
-                 compressed_size, compression_level);
-    stat_size_uncompressed += pconn->compression.queue.size;
-    stat_size_compressed += compressed_size;
+    out->compressed = true;
+    out->compressed_size = compressed_size;
 
     if (!jumbo) {
       unsigned char header[2];
       FC_STATIC_ASSERT(COMPRESSION_BORDER > MAX_LEN_PACKET,
                        uncompressed_compressed_packet_len_overlap);
 
-      log_compress("COMPRESS: sending %ld as normal", compressed_size);
-
       dio_output_init(&dout, header, sizeof(header));
       dio_put_uint16_raw(&dout, 2 + compressed_size + COMPRESSION_BORDER);
-      connection_send_data(pconn, header, sizeof(header));
-      connection_send_data(pconn, compressed.data(), compressed_size);
+      out->bytes.append(reinterpret_cast<const char *>(header),
+                        sizeof(header));
     } else {
       unsigned char header[6];
       FC_STATIC_ASSERT(JUMBO_SIZE >= JUMBO_BORDER + COMPRESSION_BORDER,
                        compressed_normal_jumbo_packet_len_overlap);
 
-      log_compress("COMPRESS: sending %ld as jumbo", compressed_size);
       dio_output_init(&dout, header, sizeof(header));
       dio_put_uint16_raw(&dout, JUMBO_SIZE);
       dio_put_uint32_raw(&dout, 6 + compressed_size);
-      connection_send_data(pconn, header, sizeof(header));
-      connection_send_data(pconn, compressed.data(), compressed_size);
+      out->bytes.append(reinterpret_cast<const char *>(header),
+                        sizeof(header));
     }
+    out->bytes.append(reinterpret_cast<const char *>(compressed.data()),
+                      compressed_size);
+  }
+}
+
+/**
+   Send the result of compress_data() for the waiting data of the
+   connection. Return TRUE on success.
+ */
+static bool send_compressed_data(struct connection *pconn,
+                                 const struct compressed_data *out)
+{
+  if (!out->ok) {
+    return false;
+  }
+
+  if (out->compressed) {
+    log_compress("COMPRESS: compressed %lu bytes to %ld (level %d)",
+                 (unsigned long) out->size, out->compressed_size,
+                 get_compression_level());
+    log_compress("COMPRESS: sending %ld as %s", out->compressed_size,
+                 out->compressed_size + 2 >= JUMBO_BORDER ? "jumbo"
+                                                          : "normal");
+    stat_size_uncompressed += out->size;
+    stat_size_compressed += out->compressed_size;
+    connection_send_data(
+        pconn, reinterpret_cast<const unsigned char *>(out->bytes.constData()),
+        out->bytes.size());
   } else {
     log_compress("COMPRESS: would enlarge %lu bytes to %ld; "
                  "sending uncompressed",
-                 (unsigned long) pconn->compression.queue.size,
-                 compressed_packet_len);
+                 (unsigned long) out->size, out->compressed_size);
     connection_send_data(pconn, pconn->compression.queue.p,
                          pconn->compression.queue.size);
-    stat_size_no_compression += pconn->compression.queue.size;
+    stat_size_no_compression += out->size;
   }
   return pconn->used;
 }
 
+/**
+   Send all waiting data. Return TRUE on success.
+ */
+static bool conn_compression_flush(struct connection *pconn)
+{
+  struct compressed_data out;
+
+  /* Compression signalling currently assumes a 2-byte packet length; if that
+   * changes, the protocol should probably be changed */
+  fc_assert_ret_val(
+      data_type_size(data_type(pconn->packet_header.length)) == 2, false);
+
+  compress_data(pconn->compression.queue.p, pconn->compression.queue.size,
+                get_compression_level(), &out);
+  return send_compressed_data(pconn, &out);
+}
+
+namespace {
+/**
+   Compresses the waiting data of one connection on a network worker
+   thread.
+ */
+class compress_job : public QRunnable {
+public:
+  compress_job(const struct connection *pconn, int level,
+               struct compressed_data *out)
+      : data(pconn->compression.queue.p),
+        size(pconn->compression.queue.size), level(level), out(out)
+  {
+  }
+  void run() override { compress_data(data, size, level, out); }
+
+private:
+  const unsigned char *data;
+  size_t size;
+  int level;
+  struct compressed_data *out;
+};
+} // anonymous namespace
+
+/**
+   Network worker threads used to compress the waiting data of many
+   connections at once.
+ */
+Q_GLOBAL_STATIC(QThreadPool, network_workers)
+
 /**
    Thaw the connection. Then maybe compress the data waiting to send them
    to the connection. Returns TRUE on success. See also
@@ -177,6 +261,51 @@ bool conn_compression_thaw(struct connection *pconn)
   return pconn->used;
 }
 
+/**
+   Thaw a connection list. The data waiting for the connections which get
+   fully thawed is compressed in parallel by the network worker threads,
+   then sent in the list order from this thread. Returns once all of it
+   has been handed to the connections.
+ */
+void conn_list_compression_thaw(const struct conn_list *pconn_list)
+{
+  QVector<struct connection *> flushed;
+  std::vector<struct compressed_data> results;
+  int level = get_compression_level();
+
+  conn_list_iterate(pconn_list, pconn)
+  {
+    if (1 == pconn->compression.frozen_level && pconn->used
+        && data_type_size(data_type(pconn->packet_header.length)) == 2) {
+      pconn->compression.frozen_level = 0;
+      flushed.append(pconn);
+    } else {
+      conn_compression_thaw(pconn);
+    }
+  }
+  conn_list_iterate_end;
+
+  if (flushed.size() < 2) {
+    for (auto *pconn : qAsConst(flushed)) {
+      conn_compression_flush(pconn);
+    }
+    return;
+  }
+
+  /* The queues are not touched until everything has been compressed, so
+   * the workers can read them safely. */
+  results.resize(flushed.size());
+  for (int i = 0; i < flushed.size(); i++) {
+    network_workers->start(new compress_job(flushed[i], level, &results[i]));
+  }
+  network_workers->waitForDone();
+
+  // Write in order, socket I/O stays in the main thread.
+  for (int i = 0; i < flushed.size(); i++) {
+    send_compressed_data(flushed[i], &results[i]);
+  }
+}
+
 /**
    It returns the request id of the outgoing packet (or 0 if is_server()).
  */
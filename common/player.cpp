@@ -15,6 +15,8 @@
 #include <fc_config.h>
 #endif
 
+#include <algorithm>
+
 #include <QBitArray>
 // utility
 #include "fcintl.h"
@@ -1188,6 +1190,40 @@ bool player_in_city_map(const struct player *pplayer,
   return false;
 }
 
+/**
+   Return the given tiles sorted in map order, so that they are processed
+   the same way regardless of the set layout.
+ */
+std::vector<struct tile *>
+tiles_in_map_order(const QSet<struct tile *> &tiles)
+{
+  std::vector<struct tile *> sorted(tiles.begin(), tiles.end());
+
+  std::sort(sorted.begin(), sorted.end(),
+            [](const struct tile *a, const struct tile *b) {
+              return tile_index(a) < tile_index(b);
+            });
+
+  return sorted;
+}
+
+/**
+   Return the main map tiles pplayer owns, in map order. Use this rather
+   than scanning the whole map for tile_owner().
+ */
+std::vector<struct tile *> player_owned_tiles(const struct player *pplayer)
+{
+  return tiles_in_map_order(pplayer->owned_tiles);
+}
+
+/**
+   Return the main map tiles whose extras pplayer owns, in map order.
+ */
+std::vector<struct tile *> player_owned_extras(const struct player *pplayer)
+{
+  return tiles_in_map_order(pplayer->owned_extras);
+}
+
 /**
    Returns the number of techs the player has researched which has this
    flag. Needs to be optimized later (e.g. int tech_flags[TF_COUNT] in
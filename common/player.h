@@ -12,6 +12,11 @@
       \____/        ********************************************************/
 #pragma once
 
+#include <vector>
+
+// Qt
+#include <QSet>
+
 // common
 #include "city.h"
 #include "effects.h"
@@ -285,6 +290,11 @@ struct player {
 
   QBitArray *tile_known;
 
+  // Main map tiles owned by the player, kept by tile_set_owner()
+  QSet<struct tile *> owned_tiles;
+  // Main map tiles whose extras the player owns
+  QSet<struct tile *> owned_extras;
+
   struct rgbcolor *rgb;
 
   // Values currently in force.
@@ -331,6 +341,14 @@ struct player {
 
       int huts; // How many huts this player has found
 
+      /* Counters kept up to date with tile_known, used to check
+       * achievements without scanning the map. */
+      int known_tiles;      // Number of tiles set in tile_known
+      int known_continents; // Number of continents with a known tile
+      int *continent_known_tiles; /* Known tiles per continent, indexed by
+                                   * continent id - 1 */
+      int continent_known_tiles_size;
+
       int bulbs_last_turn; // Number of bulbs researched last turn only.
     } server;
 
@@ -426,6 +444,10 @@ struct unit *player_unit_by_number(const struct player *pplayer,
 
 bool player_in_city_map(const struct player *pplayer,
                         const struct tile *ptile);
+std::vector<struct tile *>
+tiles_in_map_order(const QSet<struct tile *> &tiles);
+std::vector<struct tile *> player_owned_tiles(const struct player *pplayer);
+std::vector<struct tile *> player_owned_extras(const struct player *pplayer);
 bool player_knows_techs_with_flag(const struct player *pplayer,
                                   enum tech_flag_id flag);
 int num_known_tech_with_flag(const struct player *pplayer,
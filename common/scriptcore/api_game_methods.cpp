@@ -482,6 +482,17 @@ int api_methods_player_num_units(lua_State *L, Player *pplayer)
   return unit_list_size(pplayer->units);
 }
 
+/**
+   Return the number of tiles pplayer owns.
+ */
+int api_methods_player_num_tiles(lua_State *L, Player *pplayer)
+{
+  LUASCRIPT_CHECK_STATE(L, 0);
+  LUASCRIPT_CHECK_SELF(L, pplayer, 0);
+
+  return pplayer->owned_tiles.size();
+}
+
 /**
    Return gold for Player
  */
@@ -602,6 +613,46 @@ City_List_Link *api_methods_private_player_city_list_head(lua_State *L,
   return city_list_head(pplayer->cities);
 }
 
+/**
+   Push a new Lua array of the tiles and return its stack index.
+ */
+static lua_Object push_tile_array(lua_State *L,
+                                  const std::vector<struct tile *> &tiles)
+{
+  lua_createtable(L, tiles.size(), 0);
+  for (int i = 0; i < static_cast<int>(tiles.size()); i++) {
+    tolua_pushusertype(L, tiles[i], "Tile");
+    lua_rawseti(L, -2, i + 1);
+  }
+  return lua_gettop(L);
+}
+
+/**
+   Return a Lua array of the tiles Player owns in map order. Used by
+   Player:tiles_iterate().
+ */
+lua_Object api_methods_private_player_owned_tiles(lua_State *L,
+                                                  Player *pplayer)
+{
+  LUASCRIPT_CHECK_STATE(L, 0);
+  LUASCRIPT_CHECK_SELF(L, pplayer, 0);
+
+  return push_tile_array(L, player_owned_tiles(pplayer));
+}
+
+/**
+   Return a Lua array of the tiles whose extras Player owns in map order.
+   Used by Player:extra_tiles_iterate().
+ */
+lua_Object api_methods_private_player_owned_extra_tiles(lua_State *L,
+                                                        Player *pplayer)
+{
+  LUASCRIPT_CHECK_STATE(L, 0);
+  LUASCRIPT_CHECK_SELF(L, pplayer, 0);
+
+  return push_tile_array(L, player_owned_extras(pplayer));
+}
+
 /**
    Return rule name for Tech_Type
  */
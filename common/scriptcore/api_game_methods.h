@@ -78,6 +78,7 @@ bool api_methods_player_has_wonder(lua_State *L, Player *pplayer,
 int api_methods_player_number(lua_State *L, Player *pplayer);
 int api_methods_player_num_cities(lua_State *L, Player *pplayer);
 int api_methods_player_num_units(lua_State *L, Player *pplayer);
+int api_methods_player_num_tiles(lua_State *L, Player *pplayer);
 int api_methods_player_gold(lua_State *L, Player *pplayer);
 bool api_methods_player_knows_tech(lua_State *L, Player *pplayer,
                                    Tech_Type *ptech);
@@ -90,6 +91,10 @@ Unit_List_Link *api_methods_private_player_unit_list_head(lua_State *L,
                                                           Player *pplayer);
 City_List_Link *api_methods_private_player_city_list_head(lua_State *L,
                                                           Player *pplayer);
+lua_Object api_methods_private_player_owned_tiles(lua_State *L,
+                                                  Player *pplayer);
+lua_Object api_methods_private_player_owned_extra_tiles(lua_State *L,
+                                                        Player *pplayer);
 int api_methods_player_culture_get(lua_State *L, Player *pplayer);
 
 bool api_methods_player_has_flag(lua_State *L, Player *pplayer,
@@ -33,6 +33,37 @@
 
 static bv_extras empty_extras;
 
+/**
+   Returns whether the tile belongs to the main map, as opposed to being a
+   virtual tile.
+ */
+static bool tile_is_main(const struct tile *ptile)
+{
+  return (!map_is_empty() && tile_index(ptile) != TILE_INDEX_NONE
+          && ptile == wld.map.tiles + tile_index(ptile));
+}
+
+/**
+   Set or clear the extra bit of the tile, keeping the extra counts of the
+   main map in sync.
+ */
+static void tile_set_extra_bit(struct tile *ptile, int idx, bool present)
+{
+  if (BV_ISSET(ptile->extras, idx) == present) {
+    return;
+  }
+
+  if (present) {
+    BV_SET(ptile->extras, idx);
+  } else {
+    BV_CLR(ptile->extras, idx);
+  }
+
+  if (tile_is_main(ptile)) {
+    wld.map.extra_tile_count[idx] += (present ? 1 : -1);
+  }
+}
+
 #ifndef tile_index
 /**
    Return the tile index.
@@ -66,11 +97,35 @@ void tile_set_owner(struct tile *ptile, struct player *pplayer,
   if (BORDERS_DISABLED != game.info.borders
       // City tiles are always owned by the city owner.
       || (tile_city(ptile) != NULL || ptile->owner != NULL)) {
+    if (ptile->owner != pplayer && tile_is_main(ptile)) {
+      if (ptile->owner != NULL) {
+        ptile->owner->owned_tiles.remove(ptile);
+      }
+      if (pplayer != NULL) {
+        pplayer->owned_tiles.insert(ptile);
+      }
+    }
     ptile->owner = pplayer;
     ptile->claimer = claimer;
   }
 }
 
+/**
+   Set the owner of the extras of a tile (may be NULL).
+ */
+void tile_set_extras_owner(struct tile *ptile, struct player *pplayer)
+{
+  if (ptile->extras_owner != pplayer && tile_is_main(ptile)) {
+    if (ptile->extras_owner != NULL) {
+      ptile->extras_owner->owned_extras.remove(ptile);
+    }
+    if (pplayer != NULL) {
+      pplayer->owned_extras.insert(ptile);
+    }
+  }
+  ptile->extras_owner = pplayer;
+}
+
 /**
    Return the city on this tile (or NULL), checking for city center.
  */
@@ -135,12 +190,10 @@ void tile_set_terrain(struct tile *ptile, struct terrain *pterrain)
 
   ptile->terrain = pterrain;
   if (ptile->resource != NULL) {
-    if (NULL != pterrain
-        && terrain_has_resource(pterrain, ptile->resource)) {
-      BV_SET(ptile->extras, extra_index(ptile->resource));
-    } else {
-      BV_CLR(ptile->extras, extra_index(ptile->resource));
-    }
+    tile_set_extra_bit(ptile, extra_index(ptile->resource),
+                       NULL != pterrain
+                           && terrain_has_resource(pterrain,
+                                                   ptile->resource));
   }
 }
 
@@ -1011,7 +1064,7 @@ bool tile_has_cause_extra(const struct tile *ptile, enum extra_cause cause)
 void tile_add_extra(struct tile *ptile, const struct extra_type *pextra)
 {
   if (pextra != NULL) {
-    BV_SET(ptile->extras, extra_index(pextra));
+    tile_set_extra_bit(ptile, extra_index(pextra), true);
   }
 }
 
@@ -1021,7 +1074,7 @@ void tile_add_extra(struct tile *ptile, const struct extra_type *pextra)
 void tile_remove_extra(struct tile *ptile, const struct extra_type *pextra)
 {
   if (pextra != NULL) {
-    BV_CLR(ptile->extras, extra_index(pextra));
+    tile_set_extra_bit(ptile, extra_index(pextra), false);
   }
 }
 
@@ -77,6 +77,7 @@ void tile_set_continent(struct tile *ptile, Continent_id val);
 
 #define tile_owner(_tile) ((_tile)->owner)
 /*struct player *tile_owner(const struct tile *ptile);*/
+void tile_set_extras_owner(struct tile *ptile, struct player *pplayer);
 void tile_set_owner(struct tile *ptile, struct player *pplayer,
                     struct tile *claimer);
 #define tile_claimer(_tile) ((_tile)->claimer)
@@ -23,6 +23,9 @@ _   ._       Copyright (c) 1996-2021 Freeciv21 and Freeciv contributors.
 #include <cstdlib>
 #include <cstring>
 
+// Qt
+#include <QBitArray>
+
 // utility
 #include "fcintl.h"
 #include "log.h"
@@ -115,11 +118,8 @@ struct player *create_barbarian_player(enum barbarian_type type)
         sz_strlcpy(old_barbs->username, _(ANON_USER_NAME));
         old_barbs->unassigned_user = true;
         // I need to make them to forget the map, I think
-        whole_map_iterate(&(wld.map), ptile)
-        {
-          map_clear_known(ptile, old_barbs);
-        }
-        whole_map_iterate_end;
+        old_barbs->tile_known->fill(false);
+        player_known_tiles_recount(old_barbs);
       }
       old_barbs->economic.gold += 100; // New leader, new money
 
@@ -0,0 +1,268 @@
+/*__            ___                 ***************************************
+/   \          /   \          Copyright (c) 1996-2020 Freeciv21 and Freeciv
+\_   \        /  __/          contributors. This file is part of Freeciv21.
+ _\   \      /  /__     Freeciv21 is free software: you can redistribute it
+ \___  \____/   __/    and/or modify it under the terms of the GNU  General
+     \_       _/          Public License  as published by the Free Software
+       | @ @  \_               Foundation, either version 3 of the  License,
+       |                              or (at your option) any later version.
+     _/     /\                  You should have received  a copy of the GNU
+    /o)  (o/\ \_                General Public License along with Freeciv21.
+    \_____/ /                     If not, see https://www.gnu.org/licenses/.
+      \____/        ********************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <cstring>
+#include <vector>
+
+// Qt
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QMap>
+
+// utility
+#include "fciconv.h"
+#include "log.h"
+
+// common
+#include "city.h"
+#include "game.h"
+#include "government.h"
+#include "map.h"
+#include "player.h"
+#include "research.h"
+#include "unit.h"
+
+// server
+#include "srv_main.h"
+#include "stdinhand.h"
+
+#include "benchmark.h"
+
+namespace {
+
+/**
+   Time spent in one stage of the turn change, for the current turn and
+   for the whole benchmark.
+ */
+struct benchmark_stage {
+  const char *name;
+  qint64 turn_nsecs;
+  qint64 total_nsecs;
+};
+
+/**
+   State of the benchmark.
+ */
+struct benchmark_data {
+  // Stages, in the order in which they first completed.
+  std::vector<benchmark_stage> stages;
+  QElapsedTimer stage_timer;
+  QElapsedTimer turn_timer;
+  qint64 total_nsecs = 0;
+  int turns_done = 0;
+};
+
+} // anonymous namespace
+
+Q_GLOBAL_STATIC(benchmark_data, bench)
+
+// Number of turns to run, 0 when not benchmarking.
+static int bench_turns = 0;
+
+/**
+   Enables benchmark mode for the given number of turns.
+ */
+void benchmark_init(int turns)
+{
+  fc_assert_ret(turns > 0);
+  bench_turns = turns;
+}
+
+/**
+   Returns whether the server runs in benchmark mode.
+ */
+bool benchmark_enabled() { return bench_turns > 0; }
+
+/**
+   Turns the game that was prepared (generated or loaded) into an autogame
+   played by the AI only, and starts it. Returns FALSE if the game cannot
+   be started.
+ */
+bool benchmark_start_game()
+{
+  fc_assert_ret_val(benchmark_enabled(), false);
+
+  // Don't wait for anybody: not for human players, nor for timeouts.
+  game.server.unitwaittime = 0;
+  game.info.timeout = -1;
+  game.server.min_players = 0;
+  players_iterate(pplayer)
+  {
+    if (is_human(pplayer)) {
+      toggle_ai_player_direct(NULL, pplayer);
+    }
+  }
+  players_iterate_end;
+
+  return start_command(NULL, false, false);
+}
+
+/**
+   Starts timing a new stage.
+ */
+void benchmark_stage_start()
+{
+  if (!benchmark_enabled()) {
+    return;
+  }
+
+  if (!bench->turn_timer.isValid()) {
+    bench->turn_timer.start();
+  }
+  bench->stage_timer.start();
+}
+
+/**
+   Records the time elapsed since the last call to benchmark_stage_start()
+   or benchmark_stage_done() as spent in 'stage', and starts timing the
+   next stage. The same stage can be recorded several times in a turn.
+ */
+void benchmark_stage_done(const char *stage)
+{
+  if (!benchmark_enabled()) {
+    return;
+  }
+
+  qint64 nsecs = bench->stage_timer.nsecsElapsed();
+
+  bench->stage_timer.start();
+  for (auto &recorded : bench->stages) {
+    if (strcmp(recorded.name, stage) == 0) {
+      recorded.turn_nsecs += nsecs;
+      return;
+    }
+  }
+  bench->stages.push_back({stage, nsecs, 0});
+}
+
+/**
+   Prints the stage times of the turn that just ended and the state hash.
+   Returns TRUE once the requested number of turns has been played.
+ */
+bool benchmark_turn_done()
+{
+  fc_assert_ret_val(benchmark_enabled(), true);
+
+  // Everything since the end of the previous turn, including the parts
+  // that aren't split into stages.
+  qint64 turn_nsecs =
+      bench->turn_timer.isValid() ? bench->turn_timer.nsecsElapsed() : 0;
+
+  bench->turn_timer.start();
+  bench->total_nsecs += turn_nsecs;
+  bench->turns_done++;
+
+  fc_printf("benchmark: turn %d/%d (T%d) %.3f ms, state %s\n",
+            bench->turns_done, bench_turns, game.info.turn,
+            turn_nsecs / 1e6, benchmark_state_hash().constData());
+  for (auto &stage : bench->stages) {
+    if (stage.turn_nsecs > 0) {
+      fc_printf("benchmark:   %-36s %10.3f ms\n", stage.name,
+                stage.turn_nsecs / 1e6);
+    }
+    stage.total_nsecs += stage.turn_nsecs;
+    stage.turn_nsecs = 0;
+  }
+
+  if (bench->turns_done < bench_turns) {
+    return false;
+  }
+
+  fc_printf("benchmark: %d turns %.3f ms, %.3f ms per turn\n",
+            bench->turns_done, bench->total_nsecs / 1e6,
+            bench->total_nsecs / 1e6 / bench->turns_done);
+  for (const auto &stage : bench->stages) {
+    fc_printf("benchmark:   %-36s %10.3f ms\n", stage.name,
+              stage.total_nsecs / 1e6);
+  }
+  return true;
+}
+
+/**
+   Returns a hash of the game state that doesn't depend on the order in
+   which the server stores things: the tiles, the players and their
+   research, and the cities and units sorted by id.
+ */
+QByteArray benchmark_state_hash()
+{
+  QByteArray data;
+  QDataStream out(&data, QIODevice::WriteOnly);
+  QMap<int, const struct city *> cities;
+  QMap<int, const struct unit *> units;
+
+  out << qint32(game.info.turn) << qint32(game.info.year);
+
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    const struct extra_type *presource = tile_resource(ptile);
+    const struct player *owner = tile_owner(ptile);
+
+    out << qint32(terrain_number(tile_terrain(ptile)))
+        << qint32(presource != NULL ? extra_number(presource) : -1)
+        << qint32(owner != NULL ? player_number(owner) : -1);
+    out.writeRawData(
+        reinterpret_cast<const char *>(tile_extras(ptile)->vec),
+        sizeof(tile_extras(ptile)->vec));
+  }
+  whole_map_iterate_end;
+
+  players_iterate(pplayer)
+  {
+    const struct research *presearch = research_get(pplayer);
+
+    out << qint32(player_number(pplayer)) << pplayer->is_alive
+        << qint32(pplayer->economic.gold) << qint32(pplayer->score.game)
+        << qint32(pplayer->government != NULL
+                      ? government_number(pplayer->government)
+                      : -1)
+        << qint32(presearch->researching)
+        << qint32(presearch->bulbs_researched)
+        << qint32(presearch->techs_researched);
+
+    city_list_iterate(pplayer->cities, pcity)
+    {
+      cities.insert(pcity->id, pcity);
+    }
+    city_list_iterate_end;
+    unit_list_iterate(pplayer->units, punit)
+    {
+      units.insert(punit->id, punit);
+    }
+    unit_list_iterate_end;
+  }
+  players_iterate_end;
+
+  for (const auto *pcity : qAsConst(cities)) {
+    out << qint32(pcity->id) << qint32(player_number(city_owner(pcity)))
+        << qint32(tile_index(city_tile(pcity)))
+        << qint32(city_size_get(pcity)) << qint32(pcity->food_stock)
+        << qint32(pcity->shield_stock)
+        << qint32(pcity->production.kind)
+        << qint32(universal_number(&pcity->production));
+  }
+
+  for (const auto *punit : qAsConst(units)) {
+    out << qint32(punit->id) << qint32(player_number(unit_owner(punit)))
+        << qint32(tile_index(unit_tile(punit)))
+        << qint32(utype_number(unit_type_get(punit)))
+        << qint32(punit->hp) << qint32(punit->veteran)
+        << qint32(punit->moves_left) << qint32(punit->activity);
+  }
+
+  return QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+}
@@ -0,0 +1,34 @@
+/*__            ___                 ***************************************
+/   \          /   \          Copyright (c) 1996-2020 Freeciv21 and Freeciv
+\_   \        /  __/          contributors. This file is part of Freeciv21.
+ _\   \      /  /__     Freeciv21 is free software: you can redistribute it
+ \___  \____/   __/    and/or modify it under the terms of the GNU  General
+     \_       _/          Public License  as published by the Free Software
+       | @ @  \_               Foundation, either version 3 of the  License,
+       |                              or (at your option) any later version.
+     _/     /\                  You should have received  a copy of the GNU
+    /o)  (o/\ \_                General Public License along with Freeciv21.
+    \_____/ /                     If not, see https://www.gnu.org/licenses/.
+      \____/        ********************************************************/
+#pragma once
+
+// Qt
+#include <QByteArray>
+
+/* Benchmark mode (--benchmark): the game is played by the AI alone, as an
+ * autogame, for a fixed number of turns. The wall time spent in each stage
+ * of the turn change is printed after every turn, together with a hash of
+ * the game state, so that changes to the server can be checked for both
+ * speed and unchanged results. The stages are delimited by calls to
+ * benchmark_stage_start() and benchmark_stage_done(), which do nothing
+ * outside of benchmark mode. */
+
+void benchmark_init(int turns);
+bool benchmark_enabled();
+bool benchmark_start_game();
+
+void benchmark_stage_start();
+void benchmark_stage_done(const char *stage);
+bool benchmark_turn_done();
+
+QByteArray benchmark_state_hash();
@@ -19,6 +19,9 @@
 #include <cstdlib>
 #include <cstring>
 
+// Qt
+#include <QSet>
+
 // utility
 #include "fcintl.h"
 #include "log.h"
@@ -227,6 +230,101 @@ void handle_city_make_worker(struct player *pplayer, int city_id,
   sync_cities();
 }
 
+/**
+   Handle request to rearrange all the citizens of a city at once. The
+   packet lists every worked tile (except the free worked center) and the
+   number of each specialist. The arrangement is applied only if it is
+   valid as a whole, and the city is refreshed and sent once.
+ */
+void handle_city_set_workers(struct player *pplayer,
+                             const struct packet_city_set_workers *packet)
+{
+  struct city *pcity = player_city_by_number(pplayer, packet->city_id);
+  struct cm_result *cmr;
+  QSet<int> worked;
+  int citizens = 0, found = 0;
+
+  if (NULL == pcity) {
+    // Probably lost.
+    qDebug("handle_city_set_workers() bad city number %d.",
+           packet->city_id);
+    return;
+  }
+
+  if (packet->specialists_size != specialist_count()) {
+    qCritical("handle_city_set_workers() bad specialist count %d.",
+              packet->specialists_size);
+    return;
+  }
+
+  specialist_type_iterate(sp)
+  {
+    if (packet->specialists[sp] > 0 && sp != DEFAULT_SPECIALIST
+        && !city_can_use_specialist(pcity, sp)) {
+      qDebug("handle_city_set_workers() \"%s\" cannot use specialist %d.",
+             city_name_get(pcity), sp);
+      send_city_info(pplayer, pcity);
+      return;
+    }
+    citizens += packet->specialists[sp];
+  }
+  specialist_type_iterate_end;
+
+  for (int i = 0; i < packet->worked_count; i++) {
+    worked.insert(packet->worked[i]);
+  }
+  citizens += worked.size();
+
+  if (worked.size() != packet->worked_count
+      || citizens != city_size_get(pcity)) {
+    /* This could easily just be due to the city changing while the
+     * request was on its way. */
+    qDebug("handle_city_set_workers() bad arrangement for \"%s\".",
+           city_name_get(pcity));
+    send_city_info(pplayer, pcity);
+    return;
+  }
+
+  cmr = cm_result_new(pcity);
+  city_tile_iterate_skip_free_worked(city_map_radius_sq_get(pcity),
+                                     city_tile(pcity), ptile, idx, x, y)
+  {
+    if (!worked.contains(tile_index(ptile))) {
+      continue;
+    }
+    if (tile_worked(ptile) != pcity
+        && (NULL != tile_worked(ptile) || !city_can_work_tile(pcity, ptile))) {
+      break;
+    }
+    cmr->worker_positions[idx] = true;
+    found++;
+  }
+  city_tile_iterate_skip_free_worked_end;
+
+  if (found != worked.size()) {
+    qDebug("handle_city_set_workers() \"%s\" cannot work the tiles.",
+           city_name_get(pcity));
+    cm_result_destroy(cmr);
+    send_city_info(pplayer, pcity);
+    return;
+  }
+
+  specialist_type_iterate(sp)
+  {
+    cmr->specialists[sp] = packet->specialists[sp];
+  }
+  specialist_type_iterate_end;
+
+  apply_cmresult_to_city(pcity, cmr);
+  cm_result_destroy(cmr);
+
+  city_refresh(pcity);
+  sanity_check_city(pcity);
+  send_city_info(pplayer, pcity);
+  // Tiles freed or taken may change the other cities
+  sync_cities();
+}
+
 /**
    Handle improvement selling request. Caller is responsible to validate
    input before passing to this function if it comes from untrusted source.
@@ -592,5 +690,8 @@ void handle_city_manager(struct player *pplayer, int city_id, bool enabled,
   cm_copy_parameter(pcity->cm_parameter, &parameter);
 
   auto_arrange_workers(pcity);
+  /* Always reply, so the client knows the governor now runs here (or that
+   * it gave up already). */
+  send_city_info(pplayer, pcity);
   sync_cities();
 }
@@ -182,7 +182,8 @@ void city_refresh_for_player(struct player *pplayer)
   conn_list_do_buffer(pplayer->connections);
   city_list_iterate(pplayer->cities, pcity)
   {
-    if (city_refresh(pcity)) {
+    // Cities with a citizen governor follow every change.
+    if (city_refresh(pcity) || pcity->cm_parameter) {
       auto_arrange_workers(pcity);
     }
     send_city_info(pplayer, pcity);
@@ -219,7 +220,7 @@ void city_refresh_queue_processing()
   city_list_iterate(city_refresh_queue, pcity)
   {
     if (pcity->server.needs_refresh) {
-      if (city_refresh(pcity)) {
+      if (city_refresh(pcity) || pcity->cm_parameter) {
         auto_arrange_workers(pcity);
       }
       send_city_info(city_owner(pcity), pcity);
@@ -3451,6 +3452,12 @@ static void update_city_activity(struct city *pcity)
   pcity->did_buy = false;
   pcity->airlift = city_airlift_max(pcity);
 
+  if (pcity->cm_parameter) {
+    /* Run the citizen governor before sending, so the owner gets a single
+     * update of the rearranged city. */
+    auto_arrange_workers(pcity);
+  }
+
   send_city_info(NULL, pcity);
 
   if (city_refresh(pcity)) {
@@ -44,6 +44,7 @@
 
 // server
 #include "aiiface.h"
+#include "benchmark.h"
 #include "console.h"
 #include "meta.h"
 #include "sernet.h"
@@ -172,6 +173,10 @@ int main(int argc, char *argv[])
        _("Connect to metaserver from this address"),
        // TRANS: Command-line argument
        _("ADDR")},
+      {"benchmark",
+       _("Let the AI play TURNS turns, print timings and exit"),
+       // TRANS: Command-line argument
+       _("TURNS")},
       {{"b", "bind"},
        _("Listen for clients on ADDR"),
        // TRANS: Command-line argument
@@ -322,6 +327,20 @@ int main(int argc, char *argv[])
   if (parser.isSet(QStringLiteral("exit-on-end"))) {
     srvarg.exit_on_end = true;
   }
+  if (parser.isSet(QStringLiteral("benchmark"))) {
+    bool conversion_ok;
+    int turns =
+        parser.value(QStringLiteral("benchmark")).toInt(&conversion_ok);
+    if (!conversion_ok || turns <= 0) {
+      qFatal(_("Invalid number of turns %s"),
+             qUtf8Printable(parser.value("benchmark")));
+      exit(EXIT_FAILURE);
+    }
+    benchmark_init(turns);
+    // Stay offline
+    srvarg.announce = ANNOUNCE_NONE;
+    srvarg.metaserver_no_send = true;
+  }
   if (parser.isSet(QStringLiteral("timetrack"))) {
     srvarg.timetrack = true;
     log_time(QStringLiteral("Time tracking enabled"), true);
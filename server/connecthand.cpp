@@ -490,6 +490,7 @@ void lost_connection_to_client(struct connection *pconn)
               _("Lost connection: %s."), desc);
 
   connection_detach(pconn, true);
+  player_diplstate_conn_reset(pconn);
   send_conn_info_remove(pconn->self, game.est_connections);
   notify_if_first_access_level_is_available();
 
@@ -694,6 +695,7 @@ static bool connection_attach_real(struct connection *pconn,
   // Reset the delta-state.
   send_conn_info(pconn->self, game.est_connections); // Client side.
   conn_reset_delta_state(pconn);                     // Server side.
+  player_diplstate_conn_reset(pconn);
 
   /* Initial packets don't need to be resent.  See comment for
    * connecthand.c::establish_new_connection(). */
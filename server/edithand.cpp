@@ -139,6 +139,8 @@ static void check_edited_tile_terrains()
 {
   if (need_continents_reassigned) {
     assign_continent_numbers();
+    players_iterate(pplayer) { player_known_tiles_recount(pplayer); }
+    players_iterate_end;
     send_all_known_tiles(NULL);
     need_continents_reassigned = false;
   }
@@ -355,7 +357,7 @@ void handle_edit_tile_extra(struct connection *pc, int tile, int id,
   conn_list_do_buffer(game.est_connections);
   square_iterate(&(wld.map), ptile_center, size - 1, ptile)
   {
-    ptile->extras_owner = plr_eowner;
+    tile_set_extras_owner(ptile, plr_eowner);
     edit_tile_extra_handling(ptile, extra_by_number(id), removal, true);
   }
   square_iterate_end;
@@ -401,7 +403,7 @@ void handle_edit_tile(struct connection *pc,
   }
 
   if (ptile->extras_owner != eowner) {
-    ptile->extras_owner = eowner;
+    tile_set_extras_owner(ptile, eowner);
     changed = true;
   }
 
@@ -16,10 +16,12 @@
 #endif
 
 #include <QBitArray>
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <vector>
 
 // utility
 #include "bitvector.h"
@@ -28,6 +30,7 @@
 #include "maphand.h" // assign_continent_numbers(), MAP_NCONT
 #include "rand.h"
 #include "shared.h"
+#include "timing.h"
 
 // common
 #include "game.h"
@@ -1057,6 +1060,39 @@ static void make_rivers()
   destroy_placed_map();
 }
 
+// Wall clock time of each pass of the last map_fractal_generate() call.
+Q_GLOBAL_STATIC(mapgen_pass_times, pass_times)
+static civtimer *pass_timer = nullptr;
+
+/**
+   Forget the pass times of the previous map and start timing the first
+   pass.
+ */
+static void mapgen_passes_start()
+{
+  pass_times->clear();
+  pass_timer = timer_renew(pass_timer, TIMER_USER, TIMER_ACTIVE);
+  timer_start(pass_timer);
+}
+
+/**
+   Record the time spent since the previous pass ended as the time of the
+   pass 'name', and start timing the next one.
+ */
+static void mapgen_pass_done(const char *name)
+{
+  pass_times->append(
+      qMakePair(QString::fromLatin1(name), timer_read_seconds(pass_timer)));
+  timer_clear(pass_timer);
+  timer_start(pass_timer);
+}
+
+/**
+   Returns the wall clock time spent in each pass of the last
+   map_fractal_generate() call, in the order the passes ran.
+ */
+const mapgen_pass_times &mapgen_last_pass_times() { return *pass_times; }
+
 /**
    make land simply does it all based on a generated heightmap
    1) with map.server.landpercent it generates a ocean/unknown map
@@ -1149,10 +1185,13 @@ static void make_land()
     renormalize_hmap_poles();
   }
 
+  mapgen_pass_done("make_land");
+
   // destroy old dummy temperature map ...
   destroy_tmap();
   // ... and create a real temperature map (needs hmap and oceans)
   create_tmap(true);
+  mapgen_pass_done("create_tmap");
 
   if (HAS_POLES) {     /* this is a hack to terrains set with not frizzed
                           oceans*/
@@ -1168,8 +1207,10 @@ static void make_land()
   }
   make_terrains(); // place all exept mountains and hill
   destroy_placed_map();
+  mapgen_pass_done("make_terrains");
 
   make_rivers(); // use a new placed_map. destroy older before call
+  mapgen_pass_done("make_rivers");
 }
 
 /**
@@ -1307,6 +1348,7 @@ bool map_fractal_generate(bool autosize, struct unit_type *initial_unit)
 {
   auto rstate = fc_rand_state();
 
+  mapgen_passes_start();
   if (wld.map.server.seed_setting == 0) {
     // Create a random map seed.
     fc_rand_seed(fc_rand_state());
@@ -1331,12 +1373,17 @@ bool map_fractal_generate(bool autosize, struct unit_type *initial_unit)
     // if one mapgenerator fails, it will choose another mapgenerator
     // with a lower number to try again
 
+    mapgen_pass_done("setup");
+
     // create a temperature map
     create_tmap(false);
+    mapgen_pass_done("create_tmap");
 
-    if (MAPGEN_FAIR == wld.map.server.generator
-        && !map_generate_fair_islands()) {
-      wld.map.server.generator = MAPGEN_ISLAND;
+    if (MAPGEN_FAIR == wld.map.server.generator) {
+      if (!map_generate_fair_islands()) {
+        wld.map.server.generator = MAPGEN_ISLAND;
+      }
+      mapgen_pass_done("fair_islands");
     }
 
     if (MAPGEN_ISLAND == wld.map.server.generator) {
@@ -1360,6 +1407,7 @@ bool map_fractal_generate(bool autosize, struct unit_type *initial_unit)
 
       // free terrain selection lists used by make_island()
       island_terrain_free();
+      mapgen_pass_done("islands");
     }
 
     if (MAPGEN_FRACTAL == wld.map.server.generator) {
@@ -1369,6 +1417,7 @@ bool map_fractal_generate(bool autosize, struct unit_type *initial_unit)
               || MAPSTARTPOS_ALL == wld.map.server.startpos)
                  ? 0
                  : player_count()));
+      mapgen_pass_done("make_pseudofractal1_hmap");
     }
 
     if (MAPGEN_RANDOM == wld.map.server.generator) {
@@ -1377,10 +1426,12 @@ bool map_fractal_generate(bool autosize, struct unit_type *initial_unit)
                      - (MAPSTARTPOS_DEFAULT != wld.map.server.startpos
                             ? player_count() / 4
                             : 0)));
+      mapgen_pass_done("make_random_hmap");
     }
 
     if (MAPGEN_FRACTURE == wld.map.server.generator) {
       make_fracture_map();
+      mapgen_pass_done("make_fracture_map");
     }
 
     // if hmap only generator make anything else
@@ -1395,12 +1446,14 @@ bool map_fractal_generate(bool autosize, struct unit_type *initial_unit)
     }
 
     smooth_water_depth();
+    mapgen_pass_done("water_depth");
 
     // Continent numbers must be assigned before regenerate_lakes()
     assign_continent_numbers();
 
     // Turn small oceans into lakes.
     regenerate_lakes();
+    mapgen_pass_done("regenerate_lakes");
   } else {
     assign_continent_numbers();
   }
@@ -1413,10 +1466,12 @@ bool map_fractal_generate(bool autosize, struct unit_type *initial_unit)
   // some scenarios already provide specials
   if (!wld.map.server.have_resources) {
     add_resources(wld.map.server.riches);
+    mapgen_pass_done("add_resources");
   }
 
   if (!wld.map.server.have_huts) {
     make_huts(wld.map.server.huts * map_num_tiles() / 1000);
+    mapgen_pass_done("make_huts");
   }
 
   // restore previous random state:
@@ -1494,6 +1549,8 @@ bool map_fractal_generate(bool autosize, struct unit_type *initial_unit)
     }
   }
 
+  mapgen_pass_done("create_start_positions");
+
   // destroy temperature map
   destroy_tmap();
 
@@ -2242,7 +2299,7 @@ static void initworld(struct gen234_state *pstate)
     map_set_placed(ptile); // not a land tile
     BV_CLR_ALL(ptile->extras);
     tile_set_owner(ptile, NULL, NULL);
-    ptile->extras_owner = NULL;
+    tile_set_extras_owner(ptile, NULL);
   }
   whole_map_iterate_end;
 
@@ -2570,6 +2627,22 @@ struct fair_geometry_data {
   int transform_num;
 };
 
+/* A tile of an island template, relative to the position the template is
+ * placed at. */
+struct fair_footprint_tile {
+  int dx, dy;
+  struct fair_tile *pstile;
+};
+
+/* The used tiles of an island template after its transformations, with
+ * the tiles which may not overlap an assigned tile first. 'assigned' is
+ * the occupancy bitmap of the target map when the placement started. */
+struct fair_footprint {
+  std::vector<fair_footprint_tile> tiles;
+  int num_strict;
+  QBitArray assigned;
+};
+
 /**
    Free a map.
  */
@@ -2825,22 +2898,20 @@ static void fair_geometry_rand(struct fair_geometry_data *data)
 }
 
 /**
-   Copy 'psource' on 'ptarget' at position ('tx', 'ty'), performing
-   transformations defined into 'data'. Assign start positions for team
-   'startpos_team_id'. Return TRUE if we have copied the map, FALSE if the
-   copy was not possible.
+   Build the footprint of 'psource' under the transformations defined into
+   'data', and snapshot the tiles of 'ptarget' already assigned.
  */
-static bool fair_map_copy(struct fair_tile *ptarget, int tx, int ty,
-                          struct fair_tile *psource,
-                          const struct fair_geometry_data *data,
-                          int startpos_team_id)
+static void fair_footprint_init(struct fair_footprint *pfootprint,
+                                struct fair_tile *ptarget,
+                                struct fair_tile *psource,
+                                const struct fair_geometry_data *data)
 {
   int sdx = wld.map.xsize / 2, sdy = wld.map.ysize / 2;
   struct fair_tile *smax_tile = psource + MAP_INDEX_SIZE;
-  struct fair_tile *pstile, *pttile;
-  int x, y;
+  struct fair_tile *pstile;
+  int i, x, y;
 
-  // Check.
+  pfootprint->tiles.clear();
   for (pstile = psource; pstile < smax_tile; pstile++) {
     if (pstile->flags == FTF_NONE) {
       continue;
@@ -2851,9 +2922,58 @@ static bool fair_map_copy(struct fair_tile *ptarget, int tx, int ty,
     x -= sdx;
     y -= sdy;
     fair_do_geometry(data, &x, &y);
-    x += tx;
-    y += ty;
-    pttile = fair_map_pos_tile(ptarget, x, y);
+    pfootprint->tiles.push_back({x, y, pstile});
+  }
+
+  /* Tiles which cannot overlap anything assigned go first, they reject
+   * most of the positions. Only an ocean tile may be shared with an
+   * already assigned ocean tile. */
+  auto strict = std::stable_partition(
+      pfootprint->tiles.begin(), pfootprint->tiles.end(),
+      [](const fair_footprint_tile &ftile) {
+        return (ftile.pstile->flags & FTF_ASSIGNED
+                || !(ftile.pstile->flags & FTF_OCEAN));
+      });
+  pfootprint->num_strict = strict - pfootprint->tiles.begin();
+
+  pfootprint->assigned.fill(false, MAP_INDEX_SIZE);
+  for (i = 0; i < MAP_INDEX_SIZE; i++) {
+    if (ptarget[i].flags & FTF_ASSIGNED) {
+      pfootprint->assigned.setBit(i);
+    }
+  }
+}
+
+/**
+   Copy the footprint 'pfootprint' on 'ptarget' at position ('tx', 'ty').
+   Assign start positions for team 'startpos_team_id'. Return TRUE if we
+   have copied the map, FALSE if the copy was not possible.
+ */
+static bool fair_map_copy(struct fair_tile *ptarget, int tx, int ty,
+                          const struct fair_footprint *pfootprint,
+                          int startpos_team_id)
+{
+  struct fair_tile *pstile, *pttile;
+  int i, num_tiles = pfootprint->tiles.size();
+
+  // Quick check of the strict tiles against the occupancy bitmap.
+  for (i = 0; i < pfootprint->num_strict; i++) {
+    const struct fair_footprint_tile &ftile = pfootprint->tiles[i];
+
+    pttile = fair_map_pos_tile(ptarget, tx + ftile.dx, ty + ftile.dy);
+    if (pttile == NULL) {
+      return false; // Limit of the map.
+    }
+    if (pfootprint->assigned.testBit(pttile - ptarget)) {
+      return false; // Already assigned for another usage.
+    }
+  }
+
+  // Check.
+  for (i = 0; i < num_tiles; i++) {
+    pstile = pfootprint->tiles[i].pstile;
+    pttile = fair_map_pos_tile(ptarget, tx + pfootprint->tiles[i].dx,
+                               ty + pfootprint->tiles[i].dy);
     if (pttile == NULL) {
       return false; // Limit of the map.
     }
@@ -2876,19 +2996,10 @@ static bool fair_map_copy(struct fair_tile *ptarget, int tx, int ty,
   }
 
   // Copy.
-  for (pstile = psource; pstile < smax_tile; pstile++) {
-    if (pstile->flags == FTF_NONE) {
-      continue;
-    }
-
-    // Do translation and eventually other transformations.
-    fair_map_tile_pos(psource, pstile, &x, &y);
-    x -= sdx;
-    y -= sdy;
-    fair_do_geometry(data, &x, &y);
-    x += tx;
-    y += ty;
-    pttile = fair_map_pos_tile(ptarget, x, y);
+  for (i = 0; i < num_tiles; i++) {
+    pstile = pfootprint->tiles[i].pstile;
+    pttile = fair_map_pos_tile(ptarget, tx + pfootprint->tiles[i].dx,
+                               ty + pfootprint->tiles[i].dy);
     fc_assert_ret_val(pttile != NULL, false);
     pttile->flags =
         static_cast<fair_tile_flag>(pttile->flags | pstile->flags);
@@ -2912,15 +3023,17 @@ static bool fair_map_place_island_rand(struct fair_tile *ptarget,
                                        struct fair_tile *psource)
 {
   struct fair_geometry_data geometry;
+  struct fair_footprint footprint;
   int i, r, x, y;
 
   fair_geometry_rand(&geometry);
+  fair_footprint_init(&footprint, ptarget, psource, &geometry);
 
   // Try random positions.
   for (i = 0; i < 10; i++) {
     r = fc_rand(MAP_INDEX_SIZE);
     index_to_map_pos(&x, &y, r);
-    if (fair_map_copy(ptarget, x, y, psource, &geometry, -1)) {
+    if (fair_map_copy(ptarget, x, y, &footprint, -1)) {
       return true;
     }
   }
@@ -2929,7 +3042,7 @@ static bool fair_map_place_island_rand(struct fair_tile *ptarget,
   r = fc_rand(MAP_INDEX_SIZE);
   for (i = (r + 1) % MAP_INDEX_SIZE; i != r; i = (i + 1) % MAP_INDEX_SIZE) {
     index_to_map_pos(&x, &y, i);
-    if (fair_map_copy(ptarget, x, y, psource, &geometry, -1)) {
+    if (fair_map_copy(ptarget, x, y, &footprint, -1)) {
       return true;
     }
   }
@@ -2947,9 +3060,11 @@ static bool fair_map_place_island_team(
     const struct iter_index *outwards_indices, int startpos_team_id)
 {
   struct fair_geometry_data geometry;
+  struct fair_footprint footprint;
   int i, x, y;
 
   fair_geometry_rand(&geometry);
+  fair_footprint_init(&footprint, ptarget, psource, &geometry);
 
   /* Iterate positions, beginning by a random index of the outwards
    * indices. */
@@ -2958,8 +3073,7 @@ static bool fair_map_place_island_team(
     x = tx + outwards_indices[i].dx;
     y = ty + outwards_indices[i].dy;
     if (normalize_map_pos(&(wld.map), &x, &y)
-        && fair_map_copy(ptarget, x, y, psource, &geometry,
-                         startpos_team_id)) {
+        && fair_map_copy(ptarget, x, y, &footprint, startpos_team_id)) {
       return true;
     }
   }
@@ -3496,7 +3610,7 @@ static bool map_generate_fair_islands()
     tile_set_continent(ptile, 0);
     BV_CLR_ALL(ptile->extras);
     tile_set_owner(ptile, NULL, NULL);
-    ptile->extras_owner = NULL;
+    tile_set_extras_owner(ptile, NULL);
   }
   whole_map_iterate_end;
 
@@ -10,6 +10,14 @@
 **************************************************************************/
 #pragma once
 
+// Qt
+#include <QPair>
+#include <QString>
+#include <QVector>
+
 #include "support.h" // bool type
 
+typedef QVector<QPair<QString, double>> mapgen_pass_times;
+
 bool map_fractal_generate(bool autosize, struct unit_type *initial_unit);
+const mapgen_pass_times &mapgen_last_pass_times();
@@ -12,6 +12,14 @@ _   ._       Copyright (c) 1996-2021 Freeciv21 and Freeciv contributors.
 #include <fc_config.h>
 #endif
 
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+// Qt
+#include <QHash>
+#include <QVector>
+
 // utility
 #include "fcintl.h"
 #include "log.h"
@@ -237,10 +245,27 @@ static Continent_id *lake_surrounders = NULL;
 static int *continent_sizes = NULL;
 static int *ocean_sizes = NULL;
 
+/* The _reps arrays hold the index of one tile of each continent and ocean,
+ * so that the tiles of a single component can be reached without scanning
+ * the whole map.
+ *
+ * For each ocean, ocean_shores counts the pairs of adjacent tiles between
+ * the ocean and each continent it touches. This is the continent/ocean
+ * adjacency graph, from which lake_surrounders[] is derived.
+ *
+ * All of these are kept up to date by update_continent_numbers() when a
+ * tile changes between land and ocean, so that the whole map only has to
+ * be renumbered when a component may have been split. */
+static int *continent_reps = NULL;
+static int *ocean_reps = NULL;
+typedef QHash<int, QHash<Continent_id, int>> ocean_shores_hash;
+Q_GLOBAL_STATIC(ocean_shores_hash, ocean_shores)
+static bool continent_numbers_valid = false;
+
 /**
-   Calculate lake_surrounders[] array
+   Derive the lake_surrounders[] array from the ocean shores.
  */
-static void recalculate_lake_surrounders()
+static void update_lake_surrounders()
 {
   const size_t size = (wld.map.num_oceans + 1) * sizeof(*lake_surrounders);
 
@@ -248,6 +273,23 @@ static void recalculate_lake_surrounders()
       static_cast<Continent_id *>(fc_realloc(lake_surrounders, size));
   memset(lake_surrounders, 0, size);
 
+  for (auto it = ocean_shores->cbegin(); it != ocean_shores->cend(); ++it) {
+    fc_assert_action(it.key() <= wld.map.num_oceans, continue);
+    if (it.value().size() == 1) {
+      lake_surrounders[it.key()] = it.value().cbegin().key();
+    } else if (it.value().size() > 1) {
+      lake_surrounders[it.key()] = -1;
+    }
+  }
+}
+
+/**
+   Calculate ocean shores and lake_surrounders[] array
+ */
+static void recalculate_lake_surrounders()
+{
+  ocean_shores->clear();
+
   whole_map_iterate(&(wld.map), ptile)
   {
     const struct terrain *pterrain = tile_terrain(ptile);
@@ -263,17 +305,15 @@ static void recalculate_lake_surrounders()
         Continent_id cont2 = tile_continent(tile2);
 
         if (is_ocean_tile(tile2)) {
-          if (lake_surrounders[-cont2] == 0) {
-            lake_surrounders[-cont2] = cont;
-          } else if (lake_surrounders[-cont2] != cont) {
-            lake_surrounders[-cont2] = -1;
-          }
+          (*ocean_shores)[-cont2][cont]++;
         }
       }
       adjc_iterate_end;
     }
   }
   whole_map_iterate_end;
+
+  update_lake_surrounders();
 }
 
 /**
@@ -443,6 +483,276 @@ int get_ocean_size(Continent_id id)
   return ocean_sizes[id];
 }
 
+/**
+   Add a new, empty continent (is_land) or ocean, with the given tile as
+   representative. Returns its number.
+ */
+static Continent_id add_component(const struct tile *ptile, bool is_land)
+{
+  if (is_land) {
+    int nr = ++wld.map.num_continents;
+
+    continent_sizes = static_cast<int *>(
+        fc_realloc(continent_sizes, (nr + 1) * sizeof(*continent_sizes)));
+    continent_reps = static_cast<int *>(
+        fc_realloc(continent_reps, (nr + 1) * sizeof(*continent_reps)));
+    continent_sizes[nr] = 0;
+    continent_reps[nr] = tile_index(ptile);
+    return nr;
+  } else {
+    int nr = ++wld.map.num_oceans;
+
+    ocean_sizes = static_cast<int *>(
+        fc_realloc(ocean_sizes, (nr + 1) * sizeof(*ocean_sizes)));
+    ocean_reps = static_cast<int *>(
+        fc_realloc(ocean_reps, (nr + 1) * sizeof(*ocean_reps)));
+    ocean_sizes[nr] = 0;
+    ocean_reps[nr] = tile_index(ptile);
+    return -nr;
+  }
+}
+
+/**
+   Return a pointer to the size of the continent or ocean.
+ */
+static int *component_size(Continent_id id)
+{
+  return id > 0 ? &continent_sizes[id] : &ocean_sizes[-id];
+}
+
+/**
+   Return a pointer to the representative tile index of the continent or
+   ocean.
+ */
+static int *component_rep(Continent_id id)
+{
+  return id > 0 ? &continent_reps[id] : &ocean_reps[-id];
+}
+
+/**
+   Renumber all the tiles of the component 'from', which contains 'start',
+   to 'to'. Only the tiles of that component are visited.
+ */
+static void relabel_component(struct tile *start, Continent_id from,
+                              Continent_id to)
+{
+  std::vector<struct tile *> stack;
+
+  fc_assert_ret(tile_continent(start) == from && from != to);
+
+  tile_set_continent(start, to);
+  stack.push_back(start);
+  while (!stack.empty()) {
+    struct tile *ptile = stack.back();
+
+    stack.pop_back();
+    adjc_iterate(&(wld.map), ptile, tile2)
+    {
+      if (tile_continent(tile2) == from) {
+        tile_set_continent(tile2, to);
+        stack.push_back(tile2);
+      }
+    }
+    adjc_iterate_end;
+  }
+}
+
+/**
+   Move the shores of the component 'from' to the component 'to' (both
+   continents or both oceans).
+ */
+static void move_shores(Continent_id from, Continent_id to)
+{
+  if (from > 0) {
+    for (auto it = ocean_shores->begin(); it != ocean_shores->end(); ++it) {
+      if (it.value().contains(from)) {
+        int count = it.value().take(from);
+
+        it.value()[to] += count;
+      }
+    }
+  } else {
+    const auto shores = ocean_shores->take(-from);
+
+    for (auto it = shores.cbegin(); it != shores.cend(); ++it) {
+      (*ocean_shores)[-to][it.key()] += it.value();
+    }
+  }
+}
+
+/**
+   Add (change = 1) or remove (change = -1) the shores between the tile
+   and the tiles adjacent to it.
+ */
+static void tile_shores_change(const struct tile *ptile, int change)
+{
+  Continent_id cont = tile_continent(ptile);
+
+  adjc_iterate(&(wld.map), ptile, tile2)
+  {
+    Continent_id cont2 = tile_continent(tile2);
+    Continent_id ocean = 0, land = 0;
+
+    if (cont > 0 && cont2 < 0) {
+      ocean = -cont2;
+      land = cont;
+    } else if (cont < 0 && cont2 > 0) {
+      ocean = -cont;
+      land = cont2;
+    } else {
+      continue;
+    }
+
+    auto &shores = (*ocean_shores)[ocean];
+    int count = shores.value(land) + change;
+
+    if (count > 0) {
+      shores[land] = count;
+    } else {
+      shores.remove(land);
+    }
+  }
+  adjc_iterate_end;
+}
+
+/**
+   Forget the component 'id', which must be empty, and give its number to
+   the last component of the same kind so that numbers stay contiguous.
+ */
+static void remove_component(Continent_id id)
+{
+  Continent_id last =
+      id > 0 ? wld.map.num_continents : -wld.map.num_oceans;
+
+  fc_assert(*component_size(id) == 0);
+
+  if (id != last) {
+    relabel_component(index_to_tile(&(wld.map), *component_rep(last)), last,
+                      id);
+    *component_size(id) = *component_size(last);
+    *component_rep(id) = *component_rep(last);
+    move_shores(last, id);
+  }
+
+  if (id > 0) {
+    wld.map.num_continents--;
+  } else {
+    ocean_shores->remove(-last);
+    wld.map.num_oceans--;
+  }
+}
+
+/**
+   Returns TRUE if the tiles of the list are connected to each other
+   without going through any other tile.
+ */
+static bool tiles_locally_connected(const QVector<struct tile *> &tiles)
+{
+  QVector<struct tile *> reached = {tiles.first()};
+
+  for (int i = 0; i < reached.size(); i++) {
+    for (auto *ptile : tiles) {
+      if (!reached.contains(ptile) && is_tiles_adjacent(reached[i], ptile)) {
+        reached.append(ptile);
+      }
+    }
+  }
+
+  return reached.size() == tiles.size();
+}
+
+/**
+   Update the continent numbers after the terrain of the tile changed
+   between land and ocean. The tile joins (and possibly merges) the
+   components next to it and leaves its old one; only when the old one may
+   have been split in two is the whole map renumbered.
+
+   Returns TRUE if the tile is the only one whose number changed, FALSE if
+   other tiles were renumbered as well.
+ */
+bool update_continent_numbers(struct tile *ptile)
+{
+  const struct terrain *pterrain = tile_terrain(ptile);
+  Continent_id old_id = tile_continent(ptile), new_id;
+  QVector<struct tile *> old_adjc;
+  QVector<Continent_id> new_adjc;
+  bool is_land, renumbered = false;
+
+  if (!continent_numbers_valid || T_UNKNOWN == pterrain || 0 == old_id) {
+    assign_continent_numbers();
+    return false;
+  }
+
+  is_land = (terrain_type_terrain_class(pterrain) != TC_OCEAN);
+  if (is_land == (old_id > 0)) {
+    // Still the same kind of component.
+    return true;
+  }
+
+  adjc_iterate(&(wld.map), ptile, tile2)
+  {
+    Continent_id id2 = tile_continent(tile2);
+
+    if (id2 == old_id) {
+      old_adjc.append(tile2);
+    } else if (0 != id2 && (id2 > 0) == is_land
+               && !new_adjc.contains(id2)) {
+      new_adjc.append(id2);
+    }
+  }
+  adjc_iterate_end;
+
+  if (old_adjc.size() > 1 && !tiles_locally_connected(old_adjc)) {
+    // The old component may be split, no way to tell without flooding.
+    assign_continent_numbers();
+    return false;
+  }
+
+  // Leave the old component.
+  tile_shores_change(ptile, -1);
+  (*component_size(old_id))--;
+  if (!old_adjc.isEmpty() && *component_rep(old_id) == tile_index(ptile)) {
+    *component_rep(old_id) = tile_index(old_adjc.first());
+  }
+
+  // Join the new one, merging all of the adjacent ones into one.
+  if (new_adjc.isEmpty()) {
+    new_id = add_component(ptile, is_land);
+  } else {
+    /* Keep the lowest number; removing the highest numbers first makes
+     * sure that remove_component() never moves a number still in use
+     * here. */
+    std::sort(new_adjc.begin(), new_adjc.end(),
+              [](Continent_id a, Continent_id b) {
+                return abs(a) < abs(b);
+              });
+    new_id = new_adjc.first();
+    for (int i = new_adjc.size() - 1; i > 0; i--) {
+      Continent_id id = new_adjc[i];
+
+      relabel_component(index_to_tile(&(wld.map), *component_rep(id)), id,
+                        new_id);
+      *component_size(new_id) += *component_size(id);
+      *component_size(id) = 0;
+      move_shores(id, new_id);
+      remove_component(id);
+      renumbered = true;
+    }
+  }
+  tile_set_continent(ptile, new_id);
+  (*component_size(new_id))++;
+  tile_shores_change(ptile, 1);
+
+  if (0 == *component_size(old_id)) {
+    remove_component(old_id);
+    renumbered = true;
+  }
+
+  update_lake_surrounders();
+
+  return !renumbered;
+}
+
 /**
    Assigns continent and ocean numbers to all tiles, and set
    map.num_continents and map.num_oceans.  Recalculates continent and
@@ -475,23 +785,15 @@ void assign_continent_numbers()
     }
 
     if (terrain_type_terrain_class(pterrain) != TC_OCEAN) {
-      wld.map.num_continents++;
-      continent_sizes = static_cast<int *>(
-          fc_realloc(continent_sizes, (wld.map.num_continents + 1)
-                                          * sizeof(*continent_sizes)));
-      continent_sizes[wld.map.num_continents] = 0;
-      assign_continent_flood(ptile, true, wld.map.num_continents);
+      assign_continent_flood(ptile, true, add_component(ptile, true));
     } else {
-      wld.map.num_oceans++;
-      ocean_sizes = static_cast<int *>(fc_realloc(
-          ocean_sizes, (wld.map.num_oceans + 1) * sizeof(*ocean_sizes)));
-      ocean_sizes[wld.map.num_oceans] = 0;
-      assign_continent_flood(ptile, false, -wld.map.num_oceans);
+      assign_continent_flood(ptile, false, add_component(ptile, false));
     }
   }
   whole_map_iterate_end;
 
   recalculate_lake_surrounders();
+  continent_numbers_valid = true;
 
   qDebug("Map has %d continents and %d oceans", wld.map.num_continents,
          wld.map.num_oceans);
@@ -690,6 +992,16 @@ void generator_free()
     free(ocean_sizes);
     ocean_sizes = NULL;
   }
+  if (continent_reps != NULL) {
+    free(continent_reps);
+    continent_reps = NULL;
+  }
+  if (ocean_reps != NULL) {
+    free(ocean_reps);
+    ocean_reps = NULL;
+  }
+  ocean_shores->clear();
+  continent_numbers_valid = false;
 }
 
 /**
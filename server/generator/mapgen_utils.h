@@ -19,6 +19,7 @@ void generator_free();
 void regenerate_lakes();
 void smooth_water_depth();
 void assign_continent_numbers();
+bool update_continent_numbers(struct tile *ptile);
 int get_lake_surrounders(Continent_id cont);
 int get_continent_size(Continent_id id);
 int get_ocean_size(Continent_id id);
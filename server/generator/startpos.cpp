@@ -16,9 +16,12 @@
 #endif
 
 #include <QBitArray>
+#include <QByteArray>
+#include <QHash>
 #include <cmath> // sqrt, HUGE_VAL
 
 // utility
+#include "bitvector.h"
 #include "fcintl.h"
 #include "log.h"
 
@@ -127,6 +130,61 @@ static int get_tile_value(struct tile *ptile)
   return value;
 }
 
+BV_DEFINE(bv_startpos_terrains, MAX_NUM_TERRAINS);
+
+/**
+   Append the raw bytes of 'value' to 'signature'.
+ */
+template <typename T>
+static inline void signature_append(QByteArray &signature, const T &value)
+{
+  signature.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+/**
+   Return the signature of everything get_tile_value() depends on: the
+   terrain, resource and extras of the tile, and the terrains and extras
+   found in its cardinally adjacent and adjacent ranges (used by the
+   requirements of roads, irrigation and mines, and by tile output
+   effects). Tiles with equal signatures have equal values.
+ */
+static QByteArray tile_value_signature(const struct tile *ptile)
+{
+  const struct extra_type *presource = tile_resource(ptile);
+  bv_startpos_terrains cadjc_terrains, adjc_terrains;
+  bv_extras cadjc_extras, adjc_extras;
+  QByteArray signature;
+
+  BV_CLR_ALL(cadjc_terrains);
+  BV_CLR_ALL(cadjc_extras);
+  cardinal_adjc_iterate(&(wld.map), ptile, atile)
+  {
+    BV_SET(cadjc_terrains, terrain_index(tile_terrain(atile)));
+    BV_SET_ALL_FROM(cadjc_extras, *tile_extras(atile));
+  }
+  cardinal_adjc_iterate_end;
+
+  adjc_terrains = cadjc_terrains;
+  adjc_extras = cadjc_extras;
+  adjc_iterate(&(wld.map), ptile, atile)
+  {
+    BV_SET(adjc_terrains, terrain_index(tile_terrain(atile)));
+    BV_SET_ALL_FROM(adjc_extras, *tile_extras(atile));
+  }
+  adjc_iterate_end;
+
+  signature_append(signature, terrain_index(tile_terrain(ptile)));
+  signature_append(signature,
+                   presource != NULL ? extra_index(presource) : -1);
+  signature_append(signature, *tile_extras(ptile));
+  signature_append(signature, cadjc_terrains);
+  signature_append(signature, cadjc_extras);
+  signature_append(signature, adjc_terrains);
+  signature_append(signature, adjc_extras);
+
+  return signature;
+}
+
 struct start_filter_data {
   int min_value;
   struct unit_type *initial_unit;
@@ -353,12 +411,30 @@ bool create_start_positions(enum map_startpos mode,
   tile_value_aux = new int[MAP_INDEX_SIZE]();
   tile_value = new int[MAP_INDEX_SIZE]();
 
-  // get the tile value
-  whole_map_iterate(&(wld.map), value_tile)
+  /* Get the tile value. Most tiles share their surroundings with many
+   * others, so each distinct signature is only valued once. */
   {
-    tile_value_aux[tile_index(value_tile)] = get_tile_value(value_tile);
+    QHash<QByteArray, int> value_cache;
+
+    whole_map_iterate(&(wld.map), value_tile)
+    {
+      QByteArray signature = tile_value_signature(value_tile);
+      auto cached = value_cache.constFind(signature);
+      int value;
+
+      if (cached != value_cache.constEnd()) {
+        value = *cached;
+      } else {
+        value = get_tile_value(value_tile);
+        value_cache.insert(signature, value);
+      }
+      tile_value_aux[tile_index(value_tile)] = value;
+    }
+    whole_map_iterate_end;
+
+    log_debug("%d distinct tile values for %d tiles", value_cache.size(),
+              MAP_INDEX_SIZE);
   }
-  whole_map_iterate_end;
 
   // select the best tiles
   whole_map_iterate(&(wld.map), value_tile)
@@ -15,7 +15,11 @@
 #include <fc_config.h>
 #endif
 
+#include <climits>
+#include <vector>
+
 #include <QBitArray>
+#include <QSet>
 
 // utility
 #include "bitvector.h"
@@ -671,7 +675,7 @@ void map_vision_update(struct player *pplayer, struct tile *ptile,
                        const v_radius_t new_radius_sq, bool can_reveal_tiles)
 {
   v_radius_t change;
-  int max_radius;
+  int max_radius, min_radius;
 
   if (old_radius_sq[V_MAIN] == new_radius_sq[V_MAIN]
       && old_radius_sq[V_INVIS] == new_radius_sq[V_INVIS]
@@ -679,8 +683,10 @@ void map_vision_update(struct player *pplayer, struct tile *ptile,
     return;
   }
 
-  // Determines 'max_radius' value.
+  /* Determines 'max_radius' value, and 'min_radius' within which no layer
+   * changes. */
   max_radius = 0;
+  min_radius = INT_MAX;
   vision_layer_iterate(v)
   {
     if (max_radius < old_radius_sq[v]) {
@@ -689,6 +695,9 @@ void map_vision_update(struct player *pplayer, struct tile *ptile,
     if (max_radius < new_radius_sq[v]) {
       max_radius = new_radius_sq[v];
     }
+    if (old_radius_sq[v] != new_radius_sq[v]) {
+      min_radius = MIN(min_radius, MIN(old_radius_sq[v], new_radius_sq[v]));
+    }
   }
   vision_layer_iterate_end;
 
@@ -706,6 +715,10 @@ void map_vision_update(struct player *pplayer, struct tile *ptile,
   buffer_shared_vision(pplayer);
   circle_dxyr_iterate(&(wld.map), ptile, max_radius, tile1, dx, dy, dr)
   {
+    if (dr <= min_radius) {
+      // Only the ring between the old and the new radius changes.
+      continue;
+    }
     vision_layer_iterate(v)
     {
       if (dr > old_radius_sq[v] && dr <= new_radius_sq[v]) {
@@ -1151,12 +1164,82 @@ void change_playertile_site(struct player_tile *ptile,
   ptile->site = new_site;
 }
 
+/**
+   Update the known tile counters of the player after 'ptile' became known
+   (change = 1) or unknown (change = -1).
+ */
+static void player_known_tiles_update(struct player *pplayer,
+                                      const struct tile *ptile, int change)
+{
+  Continent_id cont = tile_continent(ptile);
+
+  pplayer->server.known_tiles += change;
+
+  if (cont <= 0) {
+    return;
+  }
+
+  if (cont > pplayer->server.continent_known_tiles_size) {
+    int size = MAX(cont, wld.map.num_continents);
+
+    pplayer->server.continent_known_tiles = static_cast<int *>(
+        fc_realloc(pplayer->server.continent_known_tiles,
+                   size * sizeof(*pplayer->server.continent_known_tiles)));
+    memset(pplayer->server.continent_known_tiles
+               + pplayer->server.continent_known_tiles_size,
+           0,
+           (size - pplayer->server.continent_known_tiles_size)
+               * sizeof(*pplayer->server.continent_known_tiles));
+    pplayer->server.continent_known_tiles_size = size;
+  }
+
+  pplayer->server.continent_known_tiles[cont - 1] += change;
+  if (change > 0 && pplayer->server.continent_known_tiles[cont - 1] == 1) {
+    pplayer->server.known_continents++;
+  } else if (change < 0
+             && pplayer->server.continent_known_tiles[cont - 1] == 0) {
+    pplayer->server.known_continents--;
+  }
+}
+
+/**
+   Recompute the known tile counters of the player from scratch. Must be
+   called when tile_known is changed in bulk or when continents are
+   renumbered.
+ */
+void player_known_tiles_recount(struct player *pplayer)
+{
+  pplayer->server.known_tiles = 0;
+  pplayer->server.known_continents = 0;
+  if (pplayer->server.continent_known_tiles_size > 0) {
+    memset(pplayer->server.continent_known_tiles, 0,
+           pplayer->server.continent_known_tiles_size
+               * sizeof(*pplayer->server.continent_known_tiles));
+  }
+
+  if (pplayer->tile_known->size() != MAP_INDEX_SIZE
+      || pplayer->tile_known->count(true) == 0) {
+    return;
+  }
+
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    if (pplayer->tile_known->testBit(tile_index(ptile))) {
+      player_known_tiles_update(pplayer, ptile, 1);
+    }
+  }
+  whole_map_iterate_end;
+}
+
 /**
    Set known status of the tile.
  */
 void map_set_known(struct tile *ptile, struct player *pplayer)
 {
-  pplayer->tile_known->setBit(tile_index(ptile));
+  if (!pplayer->tile_known->testBit(tile_index(ptile))) {
+    pplayer->tile_known->setBit(tile_index(ptile));
+    player_known_tiles_update(pplayer, ptile, 1);
+  }
 }
 
 /**
@@ -1164,7 +1247,10 @@ void map_set_known(struct tile *ptile, struct player *pplayer)
  */
 void map_clear_known(struct tile *ptile, struct player *pplayer)
 {
-  pplayer->tile_known->setBit(tile_index(ptile), false);
+  if (pplayer->tile_known->testBit(tile_index(ptile))) {
+    pplayer->tile_known->setBit(tile_index(ptile), false);
+    player_known_tiles_update(pplayer, ptile, -1);
+  }
 }
 
 /**
@@ -1208,6 +1294,7 @@ void player_map_init(struct player *pplayer)
   whole_map_iterate_end;
 
   pplayer->tile_known->resize(MAP_INDEX_SIZE);
+  player_known_tiles_recount(pplayer);
 }
 
 /**
@@ -1225,6 +1312,12 @@ void player_map_free(struct player *pplayer)
   free(pplayer->server.private_map);
   pplayer->server.private_map = NULL;
   pplayer->tile_known->clear();
+
+  free(pplayer->server.continent_known_tiles);
+  pplayer->server.continent_known_tiles = NULL;
+  pplayer->server.continent_known_tiles_size = 0;
+  pplayer->server.known_tiles = 0;
+  pplayer->server.known_continents = 0;
 }
 
 /**
@@ -1289,7 +1382,7 @@ void remove_player_from_maps(struct player *pplayer)
       reality_changed = true;
     }
     if (extra_owner(ptile) == pplayer) {
-      ptile->extras_owner = NULL;
+      tile_set_extras_owner(ptile, NULL);
       reality_changed = true;
     }
 
@@ -1529,20 +1622,47 @@ static void really_give_tile_info_from_player_to_player(struct player *pfrom,
 }
 
 /**
-   Give information about whole map (all tiles) from player to player.
+   Add (or remove when give is FALSE) the own vision of pfrom to the seen
+   counts of all the receivers, in a single pass over the map. When giving,
+   the receivers also get the knowledge pfrom has of tiles it doesn't see.
    Does not take care of shared vision; caller is assumed to do that.
  */
-static void really_give_map_from_player_to_player(struct player *pfrom,
-                                                  struct player *pdest)
+static void
+change_shared_vision_receivers(struct player *pfrom,
+                               const std::vector<struct player *> &receivers,
+                               bool give)
 {
   whole_map_iterate(&(wld.map), ptile)
   {
-    really_give_tile_info_from_player_to_player(pfrom, pdest, ptile);
+    const int sign = (give ? 1 : -1);
+    const v_radius_t change =
+        V_RADIUS(sign * map_get_own_seen(pfrom, ptile, V_MAIN),
+                 sign * map_get_own_seen(pfrom, ptile, V_INVIS),
+                 sign * map_get_own_seen(pfrom, ptile, V_SUBSURFACE));
+    const bool seen = (0 != change[V_MAIN] || 0 != change[V_INVIS]);
+    const bool known = map_is_known(ptile, pfrom);
+
+    if (!seen && !(give && known)) {
+      continue;
+    }
+
+    for (auto *pdest : receivers) {
+      if (seen) {
+        map_change_seen(pdest, ptile, change, give && known);
+      }
+      if (give) {
+        /* Squares that are not seen, but which pfrom may have more
+         * recent knowledge of. */
+        really_give_tile_info_from_player_to_player(pfrom, pdest, ptile);
+      }
+    }
   }
   whole_map_iterate_end;
 
-  city_thaw_workers_queue();
-  sync_cities();
+  if (give) {
+    city_thaw_workers_queue();
+    sync_cities();
+  }
 }
 
 /**
@@ -1571,41 +1691,31 @@ static void give_tile_info_from_player_to_player(struct player *pfrom,
  */
 static void create_vision_dependencies()
 {
-  int added;
-
+  /* In words: Everyone reachable from a player through shared vision
+   * edges is given vision by that player. Each player's set is built with
+   * a single depth-first walk. */
   players_iterate(pplayer)
   {
-    pplayer->server.really_gives_vision = pplayer->gives_shared_vision;
-  }
-  players_iterate_end;
+    std::vector<struct player *> stack = {pplayer};
 
-  /* In words: This terminates when it has run a round without adding
-     a dependency. One loop only propagates dependencies one level deep,
-     which is why we keep doing it as long as changes occur. */
-  do {
-    added = 0;
-    players_iterate(pplayer)
-    {
-      players_iterate(pplayer2)
+    BV_CLR_ALL(pplayer->server.really_gives_vision);
+    while (!stack.empty()) {
+      struct player *pgiver = stack.back();
+
+      stack.pop_back();
+      players_iterate(preceiver)
       {
-        if (really_gives_vision(pplayer, pplayer2) && pplayer != pplayer2) {
-          players_iterate(pplayer3)
-          {
-            if (really_gives_vision(pplayer2, pplayer3)
-                && !really_gives_vision(pplayer, pplayer3)
-                && pplayer != pplayer3) {
-              BV_SET(pplayer->server.really_gives_vision,
-                     player_index(pplayer3));
-              added++;
-            }
-          }
-          players_iterate_end;
+        if (preceiver != pplayer && gives_shared_vision(pgiver, preceiver)
+            && !really_gives_vision(pplayer, preceiver)) {
+          BV_SET(pplayer->server.really_gives_vision,
+                 player_index(preceiver));
+          stack.push_back(preceiver);
         }
       }
       players_iterate_end;
     }
-    players_iterate_end;
-  } while (added > 0);
+  }
+  players_iterate_end;
 }
 
 /**
@@ -1637,7 +1747,8 @@ void give_shared_vision(struct player *pfrom, struct player *pto)
 
   players_iterate(pplayer)
   {
-    buffer_shared_vision(pplayer);
+    std::vector<struct player *> receivers;
+
     players_iterate(pplayer2)
     {
       if (really_gives_vision(pplayer, pplayer2)
@@ -1645,27 +1756,16 @@ void give_shared_vision(struct player *pfrom, struct player *pto)
                        player_index(pplayer2))) {
         log_debug("really giving shared vision from %s to %s",
                   player_name(pplayer), player_name(pplayer2));
-        whole_map_iterate(&(wld.map), ptile)
-        {
-          const v_radius_t change =
-              V_RADIUS(map_get_own_seen(pplayer, ptile, V_MAIN),
-                       map_get_own_seen(pplayer, ptile, V_INVIS),
-                       map_get_own_seen(pplayer, ptile, V_SUBSURFACE));
-
-          if (0 < change[V_MAIN] || 0 < change[V_INVIS]) {
-            map_change_seen(pplayer2, ptile, change,
-                            map_is_known(ptile, pplayer));
-          }
-        }
-        whole_map_iterate_end;
-
-        /* squares that are not seen, but which pfrom may have more recent
-           knowledge of */
-        really_give_map_from_player_to_player(pplayer, pplayer2);
+        receivers.push_back(pplayer2);
       }
     }
     players_iterate_end;
-    unbuffer_shared_vision(pplayer);
+
+    if (!receivers.empty()) {
+      buffer_shared_vision(pplayer);
+      change_shared_vision_receivers(pplayer, receivers, true);
+      unbuffer_shared_vision(pplayer);
+    }
   }
   players_iterate_end;
 
@@ -1703,7 +1803,8 @@ void remove_shared_vision(struct player *pfrom, struct player *pto)
 
   players_iterate(pplayer)
   {
-    buffer_shared_vision(pplayer);
+    std::vector<struct player *> receivers;
+
     players_iterate(pplayer2)
     {
       if (!really_gives_vision(pplayer, pplayer2)
@@ -1711,22 +1812,16 @@ void remove_shared_vision(struct player *pfrom, struct player *pto)
                       player_index(pplayer2))) {
         log_debug("really removing shared vision from %s to %s",
                   player_name(pplayer), player_name(pplayer2));
-        whole_map_iterate(&(wld.map), ptile)
-        {
-          const v_radius_t change =
-              V_RADIUS(-map_get_own_seen(pplayer, ptile, V_MAIN),
-                       -map_get_own_seen(pplayer, ptile, V_INVIS),
-                       -map_get_own_seen(pplayer, ptile, V_SUBSURFACE));
-
-          if (0 > change[V_MAIN] || 0 > change[V_INVIS]) {
-            map_change_seen(pplayer2, ptile, change, false);
-          }
-        }
-        whole_map_iterate_end;
+        receivers.push_back(pplayer2);
       }
     }
     players_iterate_end;
-    unbuffer_shared_vision(pplayer);
+
+    if (!receivers.empty()) {
+      buffer_shared_vision(pplayer);
+      change_shared_vision_receivers(pplayer, receivers, false);
+      unbuffer_shared_vision(pplayer);
+    }
   }
   players_iterate_end;
 
@@ -1917,6 +2012,37 @@ bool need_to_reassign_continents(const struct terrain *oldter,
   return (old_is_ocean && !new_is_ocean) || (!old_is_ocean && new_is_ocean);
 }
 
+/**
+   Update the continent numbers after the terrain of the tile changed
+   between land and ocean, and send the changes to the players. Usually
+   only the tile itself gets a new number.
+ */
+void map_update_continents(struct tile *ptile)
+{
+  players_iterate(pplayer)
+  {
+    if (map_is_known(ptile, pplayer)) {
+      player_known_tiles_update(pplayer, ptile, -1);
+    }
+  }
+  players_iterate_end;
+
+  if (update_continent_numbers(ptile)) {
+    players_iterate(pplayer)
+    {
+      if (map_is_known(ptile, pplayer)) {
+        player_known_tiles_update(pplayer, ptile, 1);
+      }
+    }
+    players_iterate_end;
+    send_tile_info(NULL, ptile, false);
+  } else {
+    players_iterate(pplayer) { player_known_tiles_recount(pplayer); }
+    players_iterate_end;
+    send_all_known_tiles(NULL);
+  }
+}
+
 /**
    Handle local side effects for a terrain change.
  */
@@ -2011,8 +2137,7 @@ void check_terrain_change(struct tile *ptile, struct terrain *oldter)
   }
 
   if (need_to_reassign_continents(oldter, newter)) {
-    assign_continent_numbers();
-    send_all_known_tiles(NULL);
+    map_update_continents(ptile);
   }
 
   claimer = tile_claimer(ptile);
@@ -2173,7 +2298,7 @@ void tile_claim_bases(struct tile *ptile, struct player *powner)
   /* This MUST be before potentially recursive call to map_claim_base(),
    * so that the recursive call will get new owner == base_loser and
    * abort recursion. */
-  ptile->extras_owner = powner;
+  tile_set_extras_owner(ptile, powner);
 
   extra_type_by_cause_iterate(EC_BASE, pextra)
   {
@@ -2340,13 +2465,27 @@ void map_calculate_borders()
 
   qDebug("map_calculate_borders()");
 
-  whole_map_iterate(&(wld.map), ptile)
+  /* Border sources are cities and owned bases. Claiming borders only
+   * hands bases to the owner of the source tile itself, so no tile becomes
+   * a source during the pass and collecting them first gives the same
+   * result as a map pass. */
+  QSet<struct tile *> sources;
+  players_iterate(pplayer)
   {
+    city_list_iterate(pplayer->cities, pcity)
+    {
+      sources.insert(city_tile(pcity));
+    }
+    city_list_iterate_end;
+    sources |= pplayer->owned_extras;
+  }
+  players_iterate_end;
+
+  for (auto *ptile : tiles_in_map_order(sources)) {
     if (is_border_source(ptile)) {
       map_claim_border(ptile, ptile->owner, -1);
     }
   }
-  whole_map_iterate_end;
 
   qDebug("map_calculate_borders() workers");
   city_thaw_workers_queue();
@@ -2543,7 +2682,7 @@ void create_extra(struct tile *ptile, const extra_type *pextra,
         }
         extra_type_by_cause_iterate_end;
 
-        ptile->extras_owner = pplayer;
+        tile_set_extras_owner(ptile, pplayer);
       }
     } else {
       // Player who already owns bases on tile claims new base
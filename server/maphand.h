@@ -79,6 +79,7 @@ bool map_is_known_and_seen(const struct tile *ptile,
 bool map_is_known(const struct tile *ptile, const struct player *pplayer);
 void map_set_known(struct tile *ptile, struct player *pplayer);
 void map_clear_known(struct tile *ptile, struct player *pplayer);
+void player_known_tiles_recount(struct player *pplayer);
 void map_know_and_see_all(struct player *pplayer);
 void show_map_to_all();
 
@@ -126,6 +127,7 @@ void fix_tile_on_terrain_change(struct tile *ptile, struct terrain *oldter,
                                 bool extend_rivers);
 bool need_to_reassign_continents(const struct terrain *oldter,
                                  const struct terrain *newter);
+void map_update_continents(struct tile *ptile);
 void bounce_units_on_terrain_change(struct tile *ptile);
 
 void vision_change_sight(struct vision *vision, const v_radius_t radius_sq);
@@ -16,6 +16,11 @@
 #endif
 
 #include <cstdarg>
+#include <vector>
+
+// Qt
+#include <QHash>
+#include <QList>
 
 // utility
 #include "bitvector.h"
@@ -86,8 +91,10 @@ static void package_player_common(struct player *plr,
 static void
 package_player_diplstate(struct player *plr1, struct player *plr2,
                          struct packet_player_diplstate *packet_ds,
-                         struct player *receiver,
-                         enum plr_info_level min_info_level);
+                         bool visible);
+static bool player_diplstate_visible(struct player *plr1,
+                                     struct player *receiver,
+                                     enum plr_info_level min_info_level);
 static void package_player_info(struct player *plr,
                                 struct packet_player_info *packet,
                                 struct player *receiver,
@@ -99,8 +106,14 @@ static void send_player_remove_info_c(const struct player_slot *pslot,
                                       struct conn_list *dest);
 static void send_player_info_c_real(struct player *src,
                                     struct conn_list *dest);
-static void send_player_diplstate_c_real(struct player *src,
-                                         struct conn_list *dest);
+static void send_player_diplstate_view(struct player *src, int viewer,
+                                       const QList<struct connection *> &conns,
+                                       int dim, bool broadcast);
+static void player_diplstate_views_invalidate(const struct player *pplayer);
+static QHash<int, QList<struct connection *>>
+conn_list_viewer_classes(const struct conn_list *dest);
+static struct player *viewer_class_receiver(int viewer);
+static enum plr_info_level viewer_class_info_level(int viewer);
 
 static void send_nation_availability_real(struct conn_list *dest,
                                           bool nationset_change);
@@ -111,6 +124,29 @@ static int shuffled_order[MAX_NUM_PLAYER_SLOTS];
 // Used by player_info_freeze() and player_info_thaw().
 static int player_info_frozen_level = 0;
 
+/* Viewer classes. Connections in the same class receive identical
+ * player info and diplstate packets. A non-negative class is the index of
+ * the player the connections are attached to (as controllers or
+ * observers). */
+#define VIEWER_NONE (-3)
+#define VIEWER_DETACHED (-2)
+#define VIEWER_GLOBAL_OBSERVER (-1)
+
+/* The diplstate matrix as last sent to one viewer class. Cells are
+ * indexed by player slot (plr1 * dim + plr2). An invalid cell is resent
+ * to every connection of the class on the next broadcast. */
+struct diplstate_view {
+  int dim = 0;
+  std::vector<struct packet_player_diplstate> cells;
+  std::vector<bool> valid;
+};
+
+// Used by send_player_diplstate_c().
+static QHash<int, struct diplstate_view> diplstate_views;
+/* Connection id -> viewer class whose diplstate_view the connection is
+ * known to be up to date with. */
+static QHash<int, int> diplstate_synced_conns;
+
 /**
    Murder a player in cold blood.
 
@@ -248,16 +284,16 @@ void kill_player(struct player *pplayer)
   unit_list_iterate_safe_end;
 
   // Remove ownership of tiles
-  whole_map_iterate(&(wld.map), ptile)
-  {
+  for (auto *ptile : player_owned_tiles(pplayer)) {
     if (tile_owner(ptile) == pplayer) {
       map_claim_ownership(ptile, NULL, NULL, false);
     }
+  }
+  for (auto *ptile : player_owned_extras(pplayer)) {
     if (extra_owner(ptile) == pplayer) {
-      ptile->extras_owner = NULL;
+      tile_set_extras_owner(ptile, NULL);
     }
   }
-  whole_map_iterate_end;
 
   /* Ensure this dead player doesn't win with a spaceship.
    * Now that would be truly unbelievably dumb - Per */
@@ -718,7 +754,7 @@ static void maybe_claim_base(struct tile *ptile, struct player *new_owner,
     }
     extra_type_by_cause_iterate_end;
 
-    ptile->extras_owner = new_owner;
+    tile_set_extras_owner(ptile, new_owner);
   }
 }
 
@@ -728,8 +764,8 @@ static void maybe_claim_base(struct tile *ptile, struct player *new_owner,
 void enter_war(struct player *pplayer, struct player *pplayer2)
 {
   // Claim bases where units are already standing
-  whole_map_iterate(&(wld.map), ptile)
-  {
+  for (auto *ptile :
+       tiles_in_map_order(pplayer->owned_extras | pplayer2->owned_extras)) {
     struct player *old_owner = extra_owner(ptile);
 
     if (old_owner == pplayer2) {
@@ -738,7 +774,6 @@ void enter_war(struct player *pplayer, struct player *pplayer2)
       maybe_claim_base(ptile, pplayer2, old_owner);
     }
   }
-  whole_map_iterate_end;
 }
 
 /**
@@ -1014,6 +1049,9 @@ void send_player_info_c(struct player *src, struct conn_list *dest)
 /**
    Really send information. If 'dest' is NULL, then it is set to
    game.est_connections.
+
+   The info is packaged once per viewer class and the same packet is sent
+   to all connections in the class.
  */
 static void send_player_info_c_real(struct player *src,
                                     struct conn_list *dest)
@@ -1028,20 +1066,64 @@ static void send_player_info_c_real(struct player *src,
 
   package_player_common(src, &info);
 
+  const auto viewers = conn_list_viewer_classes(dest);
+  for (auto it = viewers.cbegin(); it != viewers.cend(); ++it) {
+    package_player_info(src, &info, viewer_class_receiver(it.key()),
+                        viewer_class_info_level(it.key()));
+    for (auto *pconn : it.value()) {
+      send_packet_player_info(pconn, &info);
+    }
+  }
+}
+
+/**
+   Return the viewer class of the connection. Connections in the same
+   class get identical player info and diplstate packets.
+ */
+static int conn_viewer_class(const struct connection *pconn)
+{
+  if (NULL != pconn->playing) {
+    // Players (including regular observers)
+    return player_index(pconn->playing);
+  } else if (pconn->observer) {
+    // Global observer.
+    return VIEWER_GLOBAL_OBSERVER;
+  } else {
+    return VIEWER_DETACHED;
+  }
+}
+
+/**
+   Return the player receiving the packets of the viewer class, if any.
+ */
+static struct player *viewer_class_receiver(int viewer)
+{
+  return (0 <= viewer ? player_by_number(viewer) : NULL);
+}
+
+/**
+   Return the minimum info level of the viewer class.
+ */
+static enum plr_info_level viewer_class_info_level(int viewer)
+{
+  return (VIEWER_GLOBAL_OBSERVER == viewer ? INFO_FULL : INFO_MINIMUM);
+}
+
+/**
+   Group the connections of the list by viewer class.
+ */
+static QHash<int, QList<struct connection *>>
+conn_list_viewer_classes(const struct conn_list *dest)
+{
+  QHash<int, QList<struct connection *>> viewers;
+
   conn_list_iterate(dest, pconn)
   {
-    if (NULL == pconn->playing && pconn->observer) {
-      // Global observer.
-      package_player_info(src, &info, pconn->playing, INFO_FULL);
-    } else if (NULL != pconn->playing) {
-      // Players (including regular observers)
-      package_player_info(src, &info, pconn->playing, INFO_MINIMUM);
-    } else {
-      package_player_info(src, &info, NULL, INFO_MINIMUM);
-    }
-    send_packet_player_info(pconn, &info);
+    viewers[conn_viewer_class(pconn)].append(pconn);
   }
   conn_list_iterate_end;
+
+  return viewers;
 }
 
 /**
@@ -1052,53 +1134,151 @@ static void send_player_info_c_real(struct player *src,
    diplstate. It can only be send if the player exists at the destination.
    Thus, this function should be called after the player(s) exists on both
    sides of the connection.
+
+   The diplstates are packaged once per viewer class instead of once per
+   connection. When sending to all connections, only the cells that
+   changed since the last broadcast are sent to connections that are
+   already up to date.
  */
 void send_player_diplstate_c(struct player *src, struct conn_list *dest)
 {
-  if (src != NULL) {
-    send_player_diplstate_c_real(src, dest);
-    return;
+  bool broadcast = (NULL == dest || game.est_connections == dest);
+  int dim = 0;
+
+  if (!dest) {
+    dest = game.est_connections;
   }
 
-  players_iterate(pplayer) { send_player_diplstate_c_real(pplayer, dest); }
+  players_iterate(pplayer)
+  {
+    dim = MAX(dim, player_index(pplayer) + 1);
+  }
   players_iterate_end;
+
+  const auto viewers = conn_list_viewer_classes(dest);
+  for (auto it = viewers.cbegin(); it != viewers.cend(); ++it) {
+    send_player_diplstate_view(src, it.key(), it.value(), dim, broadcast);
+  }
 }
 
 /**
-   Really send information. If 'dest' is NULL, then it is set to
-   game.est_connections.
+   Returns TRUE iff the diplstate fields of both packets are identical.
  */
-static void send_player_diplstate_c_real(struct player *plr1,
-                                         struct conn_list *dest)
+static bool diplstate_packet_equal(const struct packet_player_diplstate *a,
+                                   const struct packet_player_diplstate *b)
 {
-  fc_assert_ret(plr1 != NULL);
+  return (a->type == b->type && a->turns_left == b->turns_left
+          && a->has_reason_to_cancel == b->has_reason_to_cancel
+          && a->contact_turns_left == b->contact_turns_left);
+}
 
-  if (!dest) {
-    dest = game.est_connections;
+/**
+   Send the diplstates of 'src' (or of all players if NULL) to the
+   connections 'conns', which all belong to the viewer class 'viewer'.
+
+   If 'broadcast' is TRUE, the connections are all the established
+   connections of the class, and the view of the class is updated.
+   Otherwise the cells sent are invalidated in the view, since the other
+   connections of the class did not get them.
+ */
+static void send_player_diplstate_view(struct player *src, int viewer,
+                                       const QList<struct connection *> &conns,
+                                       int dim, bool broadcast)
+{
+  struct diplstate_view &view = diplstate_views[viewer];
+  struct player *receiver = viewer_class_receiver(viewer);
+  enum plr_info_level min_info_level = viewer_class_info_level(viewer);
+  std::vector<int> changed, sent;
+
+  if (view.dim < dim) {
+    view.dim = dim;
+    view.cells.assign(dim * dim, packet_player_diplstate());
+    view.valid.assign(dim * dim, false);
   }
 
-  conn_list_iterate(dest, pconn)
+  players_iterate(plr1)
   {
+    bool visible;
+
+    if (NULL != src && plr1 != src) {
+      continue;
+    }
+
+    visible = player_diplstate_visible(plr1, receiver, min_info_level);
+
     players_iterate(plr2)
     {
       struct packet_player_diplstate packet_ds;
+      int idx = player_index(plr1) * view.dim + player_index(plr2);
 
-      if (NULL == pconn->playing && pconn->observer) {
-        // Global observer.
-        package_player_diplstate(plr1, plr2, &packet_ds, pconn->playing,
-                                 INFO_FULL);
-      } else if (NULL != pconn->playing) {
-        // Players (including regular observers)
-        package_player_diplstate(plr1, plr2, &packet_ds, pconn->playing,
-                                 INFO_MINIMUM);
-      } else {
-        package_player_diplstate(plr1, plr2, &packet_ds, NULL, INFO_MINIMUM);
+      package_player_diplstate(plr1, plr2, &packet_ds,
+                               visible || (receiver && receiver == plr2));
+
+      if (!broadcast) {
+        view.valid[idx] = false;
+        for (auto *pconn : conns) {
+          send_packet_player_diplstate(pconn, &packet_ds);
+        }
+        continue;
       }
-      send_packet_player_diplstate(pconn, &packet_ds);
+
+      if (!view.valid[idx]
+          || !diplstate_packet_equal(&view.cells[idx], &packet_ds)) {
+        view.cells[idx] = packet_ds;
+        view.valid[idx] = true;
+        changed.push_back(idx);
+      }
+      sent.push_back(idx);
     }
     players_iterate_end;
   }
-  conn_list_iterate_end;
+  players_iterate_end;
+
+  if (!broadcast) {
+    return;
+  }
+
+  for (auto *pconn : conns) {
+    bool synced =
+        (diplstate_synced_conns.value(pconn->id, VIEWER_NONE) == viewer);
+
+    for (int idx : (synced ? changed : sent)) {
+      send_packet_player_diplstate(pconn, &view.cells[idx]);
+    }
+    if (NULL == src) {
+      // The connection now has the whole matrix.
+      diplstate_synced_conns.insert(pconn->id, viewer);
+    }
+  }
+}
+
+/**
+   Forget what diplstates were sent to the connection. Must be called
+   whenever its delta state is reset or the connection goes away.
+ */
+void player_diplstate_conn_reset(const struct connection *pconn)
+{
+  diplstate_synced_conns.remove(pconn->id);
+}
+
+/**
+   Invalidate all the diplstates involving the player slot, in all viewer
+   classes. Used when a player is created or removed.
+ */
+static void player_diplstate_views_invalidate(const struct player *pplayer)
+{
+  int slot = player_index(pplayer);
+
+  diplstate_views.remove(slot);
+  for (auto &view : diplstate_views) {
+    if (slot >= view.dim) {
+      continue;
+    }
+    for (int i = 0; i < view.dim; i++) {
+      view.valid[slot * view.dim + i] = false;
+      view.valid[i * view.dim + slot] = false;
+    }
+  }
 }
 
 /**
@@ -1324,22 +1504,17 @@ static void package_player_info(struct player *plr,
 }
 
 /**
-   Package player diplstate depending on info_level. We send everything to
-   plr's connections, we send almost everything to players with embassy
-   to plr, we send a little to players we are in contact with and almost
-   nothing to everyone else.
+   Returns TRUE iff the receiver should see the real diplstates of plr1:
+   it has an embassy with plr1, or plr1 is in contact with it. The
+   receiver always sees the diplstate of plr1 towards itself.
 
-   Receiver may be NULL in which cases dummy values are sent for some
-   fields.
+   Receiver may be NULL.
  */
-static void
-package_player_diplstate(struct player *plr1, struct player *plr2,
-                         struct packet_player_diplstate *packet_ds,
-                         struct player *receiver,
-                         enum plr_info_level min_info_level)
+static bool player_diplstate_visible(struct player *plr1,
+                                     struct player *receiver,
+                                     enum plr_info_level min_info_level)
 {
   enum plr_info_level info_level;
-  struct player_diplstate *ds = player_diplstate_get(plr1, plr2);
 
   if (receiver) {
     info_level = player_info_level(plr1, receiver);
@@ -1348,18 +1523,31 @@ package_player_diplstate(struct player *plr1, struct player *plr2,
     info_level = min_info_level;
   }
 
+  return (info_level >= INFO_EMBASSY
+          || (receiver
+              && player_diplstate_get(receiver, plr1)->contact_turns_left
+                     > 0));
+}
+
+/**
+   Package player diplstate. We send the real diplstate to players that
+   can see it (see player_diplstate_visible()) and dummy values to
+   everyone else.
+ */
+static void
+package_player_diplstate(struct player *plr1, struct player *plr2,
+                         struct packet_player_diplstate *packet_ds,
+                         bool visible)
+{
+  struct player_diplstate *ds = player_diplstate_get(plr1, plr2);
+
   packet_ds->plr1 = player_index(plr1);
   packet_ds->plr2 = player_index(plr2);
   // A unique id for each combination is calculated here.
   packet_ds->diplstate_id =
       packet_ds->plr1 * MAX_NUM_PLAYER_SLOTS + packet_ds->plr2;
 
-  /* Send diplomatic status of the player to everyone they are in
-   * contact with (embassy, remaining contact turns, the receiver). */
-  if (info_level >= INFO_EMBASSY
-      || (receiver
-          && player_diplstate_get(receiver, plr1)->contact_turns_left > 0)
-      || (receiver && receiver == plr2)) {
+  if (visible) {
     packet_ds->type = ds->type;
     packet_ds->turns_left = ds->turns_left;
     packet_ds->has_reason_to_cancel = ds->has_reason_to_cancel;
@@ -1718,6 +1906,7 @@ struct player *server_create_player(int player_id, const char *ai_tname,
   if (NULL == pplayer) {
     return NULL;
   }
+  player_diplstate_views_invalidate(pplayer);
 
   if (allow_ai_type_fallbacking) {
     pplayer->savegame_ai_type_name = fc_strdup(ai_tname);
@@ -1848,6 +2037,7 @@ void server_remove_player(struct player *pplayer)
   handicaps_close(pplayer);
   ai_traits_close(pplayer);
   adv_data_close(pplayer);
+  player_diplstate_views_invalidate(pplayer);
   player_destroy(pplayer);
 
   send_updated_vote_totals(NULL);
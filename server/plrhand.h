@@ -86,6 +86,7 @@ void player_info_thaw();
 void send_player_all_c(struct player *src, struct conn_list *dest);
 void send_player_info_c(struct player *src, struct conn_list *dest);
 void send_player_diplstate_c(struct player *src, struct conn_list *dest);
+void player_diplstate_conn_reset(const struct connection *pconn);
 
 struct conn_list *player_reply_dest(struct player *pplayer);
 
@@ -15,11 +15,18 @@
 #include <fc_config.h>
 #endif
 
+#include <vector>
+
+// Qt
+#include <QElapsedTimer>
+#include <QSet>
+
 // utility
 #include "bitvector.h"
 #include "log.h"
 
 // common
+#include "achievements.h"
 #include "city.h"
 #include "game.h"
 #include "government.h"
@@ -43,7 +50,9 @@
 
 #include "sanitycheck.h"
 
-#ifdef SANITY_CHECKING
+/* Time the sampled checks of release builds may spend per turn, in
+ * milliseconds. */
+#define SANITY_SAMPLE_BUDGET 5
 
 #define SANITY_FAIL(format, ...) fc_assert_msg(false, format, ##__VA_ARGS__)
 
@@ -70,6 +79,46 @@
 static void check_city_feelings(const struct city *pcity, const char *file,
                                 const char *function, int line);
 
+/**
+   Sanity checking on the specials of one tile.
+ */
+static void check_tile_specials(struct tile *ptile, const char *file,
+                                const char *function, int line)
+{
+  const struct terrain *pterrain = tile_terrain(ptile);
+
+  extra_type_iterate(pextra)
+  {
+    if (tile_has_extra(ptile, pextra)) {
+      extra_deps_iterate(&(pextra->reqs), pdep)
+      {
+        SANITY_TILE(ptile, tile_has_extra(ptile, pdep));
+      }
+      extra_deps_iterate_end;
+    }
+  }
+  extra_type_iterate_end;
+
+  extra_type_by_cause_iterate(EC_MINE, pextra)
+  {
+    if (tile_has_extra(ptile, pextra)) {
+      SANITY_TILE(ptile, pterrain->mining_result == pterrain);
+    }
+  }
+  extra_type_by_cause_iterate_end;
+  extra_type_by_cause_iterate(EC_IRRIGATION, pextra)
+  {
+    if (tile_has_extra(ptile, pextra)) {
+      SANITY_TILE(ptile, pterrain->irrigation_result == pterrain);
+    }
+  }
+  extra_type_by_cause_iterate_end;
+
+  SANITY_TILE(ptile, terrain_index(pterrain) >= T_FIRST
+                         && terrain_index(pterrain) < terrain_count());
+}
+
+#ifdef SANITY_CHECKING
 /**
    Sanity checking on map (tile) specials.
  */
@@ -77,41 +126,42 @@ static void check_specials(const char *file, const char *function, int line)
 {
   whole_map_iterate(&(wld.map), ptile)
   {
-    const struct terrain *pterrain = tile_terrain(ptile);
+    check_tile_specials(ptile, file, function, line);
+  }
+  whole_map_iterate_end;
+}
+#endif // SANITY_CHECKING
 
-    extra_type_iterate(pextra)
-    {
-      if (tile_has_extra(ptile, pextra)) {
-        extra_deps_iterate(&(pextra->reqs), pdep)
-        {
-          SANITY_TILE(ptile, tile_has_extra(ptile, pdep));
-        }
-        extra_deps_iterate_end;
-      }
-    }
-    extra_type_iterate_end;
+/**
+   Sanity checking on the fog-of-war of one tile. The private maps of the
+   players must be allocated, i.e. the game must have started.
+ */
+static void check_tile_fow(struct tile *ptile, const char *file,
+                           const char *function, int line)
+{
+  players_iterate(pplayer)
+  {
+    struct player_tile *plr_tile = map_get_player_tile(ptile, pplayer);
 
-    extra_type_by_cause_iterate(EC_MINE, pextra)
-    {
-      if (tile_has_extra(ptile, pextra)) {
-        SANITY_TILE(ptile, pterrain->mining_result == pterrain);
-      }
-    }
-    extra_type_by_cause_iterate_end;
-    extra_type_by_cause_iterate(EC_IRRIGATION, pextra)
+    vision_layer_iterate(v)
     {
-      if (tile_has_extra(ptile, pextra)) {
-        SANITY_TILE(ptile, pterrain->irrigation_result == pterrain);
-      }
+      // underflow of unsigned int
+      SANITY_TILE(ptile, plr_tile->seen_count[v] < 30000);
+      SANITY_TILE(ptile, plr_tile->own_seen[v] < 30000);
+      SANITY_TILE(ptile, plr_tile->own_seen[v] <= plr_tile->seen_count[v]);
     }
-    extra_type_by_cause_iterate_end;
+    vision_layer_iterate_end;
 
-    SANITY_TILE(ptile, terrain_index(pterrain) >= T_FIRST
-                           && terrain_index(pterrain) < terrain_count());
+    // Lots of server bits depend on this.
+    SANITY_TILE(ptile, plr_tile->seen_count[V_INVIS]
+                           <= plr_tile->seen_count[V_MAIN]);
+    SANITY_TILE(ptile,
+                plr_tile->own_seen[V_INVIS] <= plr_tile->own_seen[V_MAIN]);
   }
-  whole_map_iterate_end;
+  players_iterate_end;
 }
 
+#ifdef SANITY_CHECKING
 /**
    Sanity checking on fog-of-war (visibility, shared vision, etc.).
  */
@@ -124,26 +174,7 @@ static void check_fow(const char *file, const char *function, int line)
 
   whole_map_iterate(&(wld.map), ptile)
   {
-    players_iterate(pplayer)
-    {
-      struct player_tile *plr_tile = map_get_player_tile(ptile, pplayer);
-
-      vision_layer_iterate(v)
-      {
-        // underflow of unsigned int
-        SANITY_TILE(ptile, plr_tile->seen_count[v] < 30000);
-        SANITY_TILE(ptile, plr_tile->own_seen[v] < 30000);
-        SANITY_TILE(ptile, plr_tile->own_seen[v] <= plr_tile->seen_count[v]);
-      }
-      vision_layer_iterate_end;
-
-      // Lots of server bits depend on this.
-      SANITY_TILE(ptile, plr_tile->seen_count[V_INVIS]
-                             <= plr_tile->seen_count[V_MAIN]);
-      SANITY_TILE(ptile,
-                  plr_tile->own_seen[V_INVIS] <= plr_tile->own_seen[V_MAIN]);
-    }
-    players_iterate_end;
+    check_tile_fow(ptile, file, function, line);
   }
   whole_map_iterate_end;
 
@@ -179,69 +210,125 @@ static void check_misc(const char *file, const char *function, int line)
   SANITY_CHECK(team_count() <= MAX_NUM_TEAM_SLOTS);
   SANITY_CHECK(normal_player_count() <= game.server.max_players);
 }
+#endif // SANITY_CHECKING
 
 /**
-   Sanity checks on the map itself.  See also check_specials.
+   Sanity checks on one tile of the map.  See also check_tile_specials.
  */
-static void check_map(const char *file, const char *function, int line)
+static void check_map_tile(struct tile *ptile, const char *file,
+                           const char *function, int line)
 {
-  whole_map_iterate(&(wld.map), ptile)
-  {
-    struct city *pcity = tile_city(ptile);
-    int cont = tile_continent(ptile);
+  struct city *pcity = tile_city(ptile);
+  int cont = tile_continent(ptile);
 
-    CHECK_INDEX(tile_index(ptile));
+  CHECK_INDEX(tile_index(ptile));
 
-    if (NULL != pcity) {
-      SANITY_TILE(ptile, same_pos(pcity->tile, ptile));
-      SANITY_TILE(ptile, tile_owner(ptile) != NULL);
-    }
+  if (NULL != tile_owner(ptile)) {
+    SANITY_TILE(ptile, tile_owner(ptile)->owned_tiles.contains(ptile));
+  }
+  if (NULL != extra_owner(ptile)) {
+    SANITY_TILE(ptile, extra_owner(ptile)->owned_extras.contains(ptile));
+  }
 
-    if (NULL == pcity && BORDERS_DISABLED == game.info.borders) {
-      // Only city tiles are claimed when borders are disabled
-      SANITY_TILE(ptile, tile_owner(ptile) == NULL);
-    }
+  if (NULL != pcity) {
+    SANITY_TILE(ptile, same_pos(pcity->tile, ptile));
+    SANITY_TILE(ptile, tile_owner(ptile) != NULL);
+  }
 
-    if (is_ocean_tile(ptile)) {
-      SANITY_TILE(ptile, cont < 0);
-      adjc_iterate(&(wld.map), ptile, tile1)
-      {
-        if (is_ocean_tile(tile1)) {
-          SANITY_TILE(ptile, tile_continent(tile1) == cont);
-        }
+  if (NULL == pcity && BORDERS_DISABLED == game.info.borders) {
+    // Only city tiles are claimed when borders are disabled
+    SANITY_TILE(ptile, tile_owner(ptile) == NULL);
+  }
+
+  if (is_ocean_tile(ptile)) {
+    SANITY_TILE(ptile, cont < 0);
+    adjc_iterate(&(wld.map), ptile, tile1)
+    {
+      if (is_ocean_tile(tile1)) {
+        SANITY_TILE(ptile, tile_continent(tile1) == cont);
       }
-      adjc_iterate_end;
-    } else {
-      SANITY_TILE(ptile, cont > 0);
-      adjc_iterate(&(wld.map), ptile, tile1)
-      {
-        if (!is_ocean_tile(tile1)) {
-          SANITY_TILE(ptile, tile_continent(tile1) == cont);
-        }
+    }
+    adjc_iterate_end;
+  } else {
+    SANITY_TILE(ptile, cont > 0);
+    adjc_iterate(&(wld.map), ptile, tile1)
+    {
+      if (!is_ocean_tile(tile1)) {
+        SANITY_TILE(ptile, tile_continent(tile1) == cont);
       }
-      adjc_iterate_end;
     }
+    adjc_iterate_end;
+  }
 
-    unit_list_iterate(ptile->units, punit)
+  unit_list_iterate(ptile->units, punit)
+  {
+    SANITY_TILE(ptile, same_pos(unit_tile(punit), ptile));
+
+    // Check diplomatic status of stacked units.
+    unit_list_iterate(ptile->units, punit2)
     {
-      SANITY_TILE(ptile, same_pos(unit_tile(punit), ptile));
+      SANITY_TILE(ptile,
+                  pplayers_allied(unit_owner(punit), unit_owner(punit2)));
+    }
+    unit_list_iterate_end;
+    if (pcity) {
+      SANITY_TILE(ptile,
+                  pplayers_allied(unit_owner(punit), city_owner(pcity)));
+    }
+  }
+  unit_list_iterate_end;
+}
 
-      // Check diplomatic status of stacked units.
-      unit_list_iterate(ptile->units, punit2)
-      {
-        SANITY_TILE(ptile,
-                    pplayers_allied(unit_owner(punit), unit_owner(punit2)));
-      }
-      unit_list_iterate_end;
-      if (pcity) {
-        SANITY_TILE(ptile,
-                    pplayers_allied(unit_owner(punit), city_owner(pcity)));
+#ifdef SANITY_CHECKING
+/**
+   Sanity checks on the map itself.  See also check_specials.
+ */
+static void check_map(const char *file, const char *function, int line)
+{
+  int extra_counts[MAX_EXTRA_TYPES] = {0};
+  int owned_tiles = 0, owned_extras = 0;
+
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    check_map_tile(ptile, file, function, line);
+
+    if (NULL != tile_owner(ptile)) {
+      owned_tiles++;
+    }
+    if (NULL != extra_owner(ptile)) {
+      owned_extras++;
+    }
+
+    extra_type_iterate(pextra)
+    {
+      if (tile_has_extra(ptile, pextra)) {
+        extra_counts[extra_index(pextra)]++;
       }
     }
-    unit_list_iterate_end;
+    extra_type_iterate_end;
   }
   whole_map_iterate_end;
+
+  players_iterate(pplayer)
+  {
+    owned_tiles -= pplayer->owned_tiles.size();
+    owned_extras -= pplayer->owned_extras.size();
+  }
+  players_iterate_end;
+  SANITY_CHECK(0 == owned_tiles);
+  SANITY_CHECK(0 == owned_extras);
+
+  // The extra counts are only established once the game has started.
+  if (S_S_INITIAL != server_state()) {
+    extra_type_iterate(pextra)
+    {
+      SANITY_CHECK(extra_counts[extra_index(pextra)]
+                   == map_extra_tile_count(pextra));
+    }
+    extra_type_iterate_end;
+  }
 }
+#endif // SANITY_CHECKING
 
 /**
    Verify that the city itself has sane values.
@@ -412,6 +499,7 @@ void real_sanity_check_city(struct city *pcity, const char *file,
   }
 }
 
+#ifdef SANITY_CHECKING
 /**
    Sanity checks on all cities in the world.
  */
@@ -430,106 +518,117 @@ static void check_cities(const char *file, const char *function, int line)
   players_iterate_end;
 }
 
+#endif // SANITY_CHECKING
+
 /**
-   Sanity checks on all units in the world.
+   Sanity checks on one unit.
  */
-static void check_units(const char *file, const char *function, int line)
+static void check_unit(struct unit *punit, const char *file,
+                       const char *function, int line)
 {
-  players_iterate(pplayer)
-  {
-    unit_list_iterate(pplayer->units, punit)
-    {
-      struct tile *ptile = unit_tile(punit);
-      struct terrain *pterr = tile_terrain(ptile);
-      struct city *pcity;
-      struct city *phome;
-      struct unit *ptrans = unit_transport_get(punit);
+  struct player *pplayer = unit_owner(punit);
+  struct tile *ptile = unit_tile(punit);
+  struct terrain *pterr = tile_terrain(ptile);
+  struct city *pcity;
+  struct city *phome;
+  struct unit *ptrans = unit_transport_get(punit);
+
+  if (IDENTITY_NUMBER_ZERO != punit->homecity) {
+    SANITY_CHECK(phome = player_city_by_number(pplayer, punit->homecity));
+    if (phome) {
+      SANITY_CHECK(city_owner(phome) == pplayer);
+    }
+  }
 
-      SANITY_CHECK(unit_owner(punit) == pplayer);
+  // Unit in the correct player list?
+  SANITY_CHECK(player_unit_by_number(unit_owner(punit), punit->id) != NULL);
 
-      if (IDENTITY_NUMBER_ZERO != punit->homecity) {
-        SANITY_CHECK(phome =
-                         player_city_by_number(pplayer, punit->homecity));
-        if (phome) {
-          SANITY_CHECK(city_owner(phome) == pplayer);
-        }
-      }
+  if (!can_unit_continue_current_activity(punit)) {
+    SANITY_FAIL("(%4d,%4d) %s has activity %s, "
+                "but it can't continue at %s",
+                TILE_XY(ptile), unit_rule_name(punit),
+                get_activity_text(punit->activity),
+                tile_get_info_text(ptile, true, 0));
+  }
 
-      // Unit in the correct player list?
-      SANITY_CHECK(player_unit_by_number(unit_owner(punit), punit->id)
-                   != NULL);
+  if (activity_requires_target(punit->activity)
+      && (punit->activity != ACTIVITY_IRRIGATE
+          || pterr->irrigation_result == pterr)
+      && (punit->activity != ACTIVITY_MINE
+          || pterr->mining_result == pterr)) {
+    SANITY_CHECK(punit->activity_target != NULL);
+  }
 
-      if (!can_unit_continue_current_activity(punit)) {
-        SANITY_FAIL("(%4d,%4d) %s has activity %s, "
-                    "but it can't continue at %s",
-                    TILE_XY(ptile), unit_rule_name(punit),
-                    get_activity_text(punit->activity),
-                    tile_get_info_text(ptile, true, 0));
-      }
+  pcity = tile_city(ptile);
+  if (pcity) {
+    SANITY_CHECK(pplayers_allied(city_owner(pcity), pplayer));
+  }
 
-      if (activity_requires_target(punit->activity)
-          && (punit->activity != ACTIVITY_IRRIGATE
-              || pterr->irrigation_result == pterr)
-          && (punit->activity != ACTIVITY_MINE
-              || pterr->mining_result == pterr)) {
-        SANITY_CHECK(punit->activity_target != NULL);
-      }
+  SANITY_CHECK(punit->moves_left >= 0);
+  SANITY_CHECK(punit->hp > 0);
 
-      pcity = tile_city(ptile);
-      if (pcity) {
-        SANITY_CHECK(pplayers_allied(city_owner(pcity), pplayer));
-      }
+  // Check for ground units in the ocean.
+  SANITY_CHECK(can_unit_exist_at_tile(&(wld.map), punit, ptile)
+               || ptrans != NULL);
 
-      SANITY_CHECK(punit->moves_left >= 0);
-      SANITY_CHECK(punit->hp > 0);
+  // Check for over-full transports.
+  SANITY_CHECK(get_transporter_occupancy(punit)
+               <= get_transporter_capacity(punit));
 
-      // Check for ground units in the ocean.
-      SANITY_CHECK(can_unit_exist_at_tile(&(wld.map), punit, ptile)
-                   || ptrans != NULL);
+  /* Check transporter. This should be last as the pointer ptrans will
+   * be modified. */
+  if (ptrans != NULL) {
+    struct unit *plevel = punit;
+    int level = 0;
 
-      // Check for over-full transports.
-      SANITY_CHECK(get_transporter_occupancy(punit)
-                   <= get_transporter_capacity(punit));
+    // Make sure the transporter is on the tile.
+    SANITY_CHECK(same_pos(unit_tile(punit), unit_tile(ptrans)));
 
-      /* Check transporter. This should be last as the pointer ptrans will
-       * be modified. */
-      if (ptrans != NULL) {
-        struct unit *plevel = punit;
-        int level = 0;
+    // Can punit be cargo for its transporter?
+    SANITY_CHECK(unit_transport_check(punit, ptrans));
 
-        // Make sure the transporter is on the tile.
-        SANITY_CHECK(same_pos(unit_tile(punit), unit_tile(ptrans)));
+    // Check that the unit is listed as transported.
+    SANITY_CHECK(unit_list_search(unit_transport_cargo(ptrans), punit)
+                 != NULL);
 
-        // Can punit be cargo for its transporter?
-        SANITY_CHECK(unit_transport_check(punit, ptrans));
+    // Check the depth of the transportation.
+    while (ptrans) {
+      struct unit_list *pcargos = unit_transport_cargo(ptrans);
 
-        // Check that the unit is listed as transported.
-        SANITY_CHECK(unit_list_search(unit_transport_cargo(ptrans), punit)
-                     != NULL);
+      SANITY_CHECK(pcargos != NULL);
+      SANITY_CHECK(level < GAME_TRANSPORT_MAX_RECURSIVE);
 
-        // Check the depth of the transportation.
-        while (ptrans) {
-          struct unit_list *pcargos = unit_transport_cargo(ptrans);
+      // Check for next level.
+      plevel = ptrans;
+      ptrans = unit_transport_get(plevel);
+      level++;
+    }
 
-          SANITY_CHECK(pcargos != NULL);
-          SANITY_CHECK(level < GAME_TRANSPORT_MAX_RECURSIVE);
+    /* Transporter capacity will be checked when transporter itself
+     * is checked */
+  }
 
-          // Check for next level.
-          plevel = ptrans;
-          ptrans = unit_transport_get(plevel);
-          level++;
-        }
+  // Check that cargo is marked as transported with this unit
+  unit_list_iterate(unit_transport_cargo(punit), pcargo)
+  {
+    SANITY_CHECK(unit_transport_get(pcargo) == punit);
+  }
+  unit_list_iterate_end;
+}
 
-        /* Transporter capacity will be checked when transporter itself
-         * is checked */
-      }
+#ifdef SANITY_CHECKING
+/**
+   Sanity checks on all units in the world.
+ */
+static void check_units(const char *file, const char *function, int line)
+{
+  players_iterate(pplayer)
+  {
+    unit_list_iterate(pplayer->units, punit)
+    {
+      SANITY_CHECK(unit_owner(punit) == pplayer);
 
-      // Check that cargo is marked as transported with this unit
-      unit_list_iterate(unit_transport_cargo(punit), pcargo)
-      {
-        SANITY_CHECK(unit_transport_get(pcargo) == punit);
-      }
-      unit_list_iterate_end;
+      check_unit(punit, file, function, line);
     }
     unit_list_iterate_end;
   }
@@ -560,6 +659,14 @@ static void check_players(const char *file, const char *function, int line)
     SANITY_CHECK(!(city_list_size(pplayer->cities) > 0
                    && !pplayer->server.got_first_city));
 
+    // Counters used by achievements
+    if (pplayer->tile_known->size() == MAP_INDEX_SIZE) {
+      SANITY_CHECK(pplayer->server.known_tiles
+                   == achievement_scan_known_tiles(pplayer));
+      SANITY_CHECK(pplayer->server.known_continents
+                   == achievement_scan_known_continents(pplayer));
+    }
+
     city_list_iterate(pplayer->cities, pcity)
     {
       if (pcity->capital == CAPITAL_PRIMARY) {
@@ -731,6 +838,8 @@ void real_sanity_check(const char *file, const char *function, int line)
   check_connections(file, function, line);
 }
 
+#endif // SANITY_CHECKING
+
 /**
    Verify that the tile has sane values. This should be called after the
    terrain is changed.
@@ -755,4 +864,146 @@ void real_sanity_check_tile(struct tile *ptile, const char *file,
   unit_list_iterate_end;
 }
 
-#endif // SANITY_CHECKING
+namespace {
+/**
+   State of the sampled checks. The cursors rotate over the tiles, cities
+   and units, so that the whole world gets checked over a number of turns.
+ */
+struct sanity_sample {
+  int turn = -1;
+  qint64 spent_ns = 0; // Time spent in the current turn
+  int tile_cursor = 0;
+  int city_cursor = 0;
+  int unit_cursor = 0;
+  QSet<int> touched_cities;
+  QSet<int> touched_tiles;
+};
+} // anonymous namespace
+
+Q_GLOBAL_STATIC(sanity_sample, sample)
+
+/**
+   Remember that the city was changed, so that it gets checked in full at
+   the next sampled check.
+ */
+void sanity_check_touch_city(const struct city *pcity)
+{
+  if (NULL != pcity) {
+    sample->touched_cities.insert(pcity->id);
+  }
+}
+
+/**
+   Remember that the tile was changed, so that it gets checked in full at
+   the next sampled check.
+ */
+void sanity_check_touch_tile(const struct tile *ptile)
+{
+  if (NULL != ptile && TILE_INDEX_NONE != tile_index(ptile)) {
+    sample->touched_tiles.insert(tile_index(ptile));
+  }
+}
+
+/**
+   All the checks done on a single tile.
+ */
+static void check_sample_tile(struct tile *ptile, const char *file,
+                              const char *function, int line)
+{
+  check_tile_specials(ptile, file, function, line);
+  check_map_tile(ptile, file, function, line);
+  if (game_was_started()) {
+    check_tile_fow(ptile, file, function, line);
+  }
+}
+
+/**
+   Cheap sanity check for release builds. Cities and tiles touched since
+   the last call are checked in full. Then a rotating window of tiles,
+   cities and units is checked until the time budget of the turn
+   (SANITY_SAMPLE_BUDGET) is used up.
+ */
+void real_sanity_check_sample(const char *file, const char *function,
+                              int line)
+{
+  QElapsedTimer timer;
+  QSet<int> touched_cities, touched_tiles;
+  std::vector<struct city *> cities;
+  std::vector<struct unit *> units;
+  qint64 budget_ns;
+  int ntiles = 0, ncities = 0, nunits = 0;
+
+  timer.start();
+  if (sample->turn != game.info.turn) {
+    sample->turn = game.info.turn;
+    sample->spent_ns = 0;
+  }
+
+  // Checking may touch more cities; those are left for the next call.
+  touched_cities.swap(sample->touched_cities);
+  touched_tiles.swap(sample->touched_tiles);
+
+  if (map_is_empty()) {
+    // Same as real_sanity_check(): nothing to check yet.
+    return;
+  }
+
+  for (int city_id : qAsConst(touched_cities)) {
+    struct city *pcity = game_city_by_number(city_id);
+
+    if (NULL != pcity) {
+      real_sanity_check_city(pcity, file, function, line);
+    }
+  }
+  for (int tindex : qAsConst(touched_tiles)) {
+    struct tile *ptile = index_to_tile(&(wld.map), tindex);
+
+    if (NULL != ptile) {
+      real_sanity_check_tile(ptile, file, function, line);
+      check_sample_tile(ptile, file, function, line);
+    }
+  }
+
+  /* The remaining budget is shared in thirds between tiles, cities and
+   * units. Whatever a kind doesn't use goes to the next ones. */
+  budget_ns = SANITY_SAMPLE_BUDGET * 1000000 - sample->spent_ns;
+
+  for (; ntiles < MAP_INDEX_SIZE && timer.nsecsElapsed() < budget_ns / 3;
+       ntiles++) {
+    sample->tile_cursor = (sample->tile_cursor + 1) % MAP_INDEX_SIZE;
+    check_sample_tile(index_to_tile(&(wld.map), sample->tile_cursor), file,
+                      function, line);
+  }
+
+  players_iterate(pplayer)
+  {
+    city_list_iterate(pplayer->cities, pcity) { cities.push_back(pcity); }
+    city_list_iterate_end;
+    unit_list_iterate(pplayer->units, punit) { units.push_back(punit); }
+    unit_list_iterate_end;
+  }
+  players_iterate_end;
+
+  for (; ncities < static_cast<int>(cities.size())
+         && timer.nsecsElapsed() < budget_ns * 2 / 3;
+       ncities++) {
+    sample->city_cursor = (sample->city_cursor + 1) % cities.size();
+    real_sanity_check_city(cities[sample->city_cursor], file, function,
+                           line);
+  }
+
+  for (; nunits < static_cast<int>(units.size())
+         && timer.nsecsElapsed() < budget_ns;
+       nunits++) {
+    sample->unit_cursor = (sample->unit_cursor + 1) % units.size();
+    check_unit(units[sample->unit_cursor], file, function, line);
+  }
+
+  sample->spent_ns += timer.nsecsElapsed();
+
+  qDebug("Sanity sample at %s:%d: %d touched cities, %d touched tiles, "
+         "%d tiles, %d cities and %d units checked in %lld us.",
+         file, line, touched_cities.size(), touched_tiles.size(), ntiles,
+         ncities, nunits,
+         static_cast<long long>(timer.nsecsElapsed() / 1000));
+}
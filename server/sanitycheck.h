@@ -20,21 +20,28 @@
 
 #define sanity_check_city(x)                                                \
   real_sanity_check_city(x, __FILE__, __FUNCTION__, __FC_LINE__)
-void real_sanity_check_city(struct city *pcity, const char *file,
-                            const char *function, int line);
-
 #define sanity_check_tile(x)                                                \
   real_sanity_check_tile(x, __FILE__, __FUNCTION__, __FC_LINE__)
-void real_sanity_check_tile(struct tile *ptile, const char *file,
-                            const char *function, int line);
-
 #define sanity_check() real_sanity_check(__FILE__, __FUNCTION__, __FC_LINE__)
 void real_sanity_check(const char *file, const char *function, int line);
 
 #else // SANITY_CHECKING
 
-#define sanity_check_city(x) (void) 0
-#define sanity_check_tile(x) (void) 0
-#define sanity_check() (void) 0
+/* Release builds only remember what was touched, and check it together
+ * with a sample of the world within a time budget per turn. */
+#define sanity_check_city(x) sanity_check_touch_city(x)
+#define sanity_check_tile(x) sanity_check_touch_tile(x)
+#define sanity_check()                                                      \
+  real_sanity_check_sample(__FILE__, __FUNCTION__, __FC_LINE__)
 
 #endif // SANITY_CHECKING
+
+void real_sanity_check_city(struct city *pcity, const char *file,
+                            const char *function, int line);
+void real_sanity_check_tile(struct tile *ptile, const char *file,
+                            const char *function, int line);
+
+void sanity_check_touch_city(const struct city *pcity);
+void sanity_check_touch_tile(const struct tile *ptile);
+void real_sanity_check_sample(const char *file, const char *function,
+                              int line);
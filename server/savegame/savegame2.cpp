@@ -2276,7 +2276,11 @@ static void sg_load_map_known(struct loaddata *loading)
         }
       }
     }
-    players_iterate(pplayer) { pplayer->tile_known->fill(false); }
+    players_iterate(pplayer)
+    {
+      pplayer->tile_known->fill(false);
+      player_known_tiles_recount(pplayer);
+    }
     players_iterate_end;
 
     /* HACK: we read the known data from hex into 32-bit integers, and
@@ -260,8 +260,7 @@ bool api_edit_change_terrain(lua_State *L, Tile *ptile, Terrain *pterr)
   tile_change_terrain(ptile, pterr);
   fix_tile_on_terrain_change(ptile, old_terrain, false);
   if (need_to_reassign_continents(old_terrain, pterr)) {
-    assign_continent_numbers();
-    send_all_known_tiles(NULL);
+    map_update_continents(ptile);
   }
 
   update_tile_knowledge(ptile);
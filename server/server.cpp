@@ -53,6 +53,7 @@
 #include "ai.h"
 #include "aiiface.h"
 #include "auth.h"
+#include "benchmark.h"
 #include "connecthand.h"
 #include "console.h"
 #include "diplhand.h"
@@ -277,6 +278,13 @@ server::server()
 
   // Prepare a game
   prepare_game();
+  if (benchmark_enabled()) {
+    if (!benchmark_start_game()) {
+      qCritical(_("Cannot start the benchmark game."));
+      return;
+    }
+    QTimer::singleShot(0, this, &server::update_game_state);
+  }
   con_prompt_init();
   if (m_interactive) {
     init_interactive();
@@ -629,12 +637,14 @@ void server::begin_phase()
   // Post-increment so we don't count the first loop.
   if (game.info.phase == 0) {
     // Create autosaves if requested.
+    benchmark_stage_start();
     if (m_save_counter >= game.server.save_nturns
         && game.server.save_nturns > 0) {
       m_save_counter = 0;
       save_game_auto("Autosave", AS_TURN);
     }
     m_save_counter++;
+    benchmark_stage_done("autosave");
 
     if (!m_skip_mapimg) {
       // Save map image(s).
@@ -650,6 +660,7 @@ void server::begin_phase()
     } else {
       m_skip_mapimg = false;
     }
+    benchmark_stage_done("map images");
   }
 
   log_debug("sniffingpackets");
@@ -716,6 +727,12 @@ void server::end_turn()
   log_debug("Sendinfotometaserver");
   (void) send_server_info_to_metaserver(META_REFRESH);
 
+  if (benchmark_enabled() && benchmark_turn_done()
+      && S_S_RUNNING == server_state()) {
+    // All the requested turns were played
+    set_server_state(S_S_OVER);
+  }
+
   if (S_S_OVER != server_state() && check_for_game_over()) {
     set_server_state(S_S_OVER);
     if (game.info.turn > game.server.end_turn) {
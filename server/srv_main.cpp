@@ -71,6 +71,7 @@
 #include "animals.h"
 #include "auth.h"
 #include "barbarian.h"
+#include "benchmark.h"
 #include "cityhand.h"
 #include "citytools.h"
 #include "cityturn.h"
@@ -735,13 +736,7 @@ static void update_environmental_upset(enum environment_upset_type type,
   extra_type_iterate(cause)
   {
     if (extra_causes_env_upset(cause, type)) {
-      whole_map_iterate(&(wld.map), ptile)
-      {
-        if (tile_has_extra(ptile, cause)) {
-          count++;
-        }
-      }
-      whole_map_iterate_end;
+      count += map_extra_tile_count(cause);
     }
   }
   extra_type_iterate_end;
@@ -1063,6 +1058,7 @@ void begin_turn(bool is_new_turn)
   QElapsedTimer timer;
   timer.start();
   log_debug("Begin turn");
+  benchmark_stage_start();
 
   event_cache_remove_old();
 
@@ -1127,6 +1123,7 @@ void begin_turn(bool is_new_turn)
     }
     players_iterate_end;
   }
+  benchmark_stage_done("begin_turn: scores");
 
   /* find out if users attached to players have been attached to those
    * players for long enough. The first user to do so becomes "associated" to
@@ -1171,6 +1168,7 @@ void begin_turn(bool is_new_turn)
     // begin_phase() only after AI players have finished their actions.
     lsend_packet_begin_turn(game.est_connections);
   }
+  benchmark_stage_done("begin_turn: other");
   log_time(
       QStringLiteral("Begin turn:%1 milliseconds").arg(timer.elapsed()));
 }
@@ -1184,8 +1182,10 @@ void begin_phase(bool is_new_phase)
   QElapsedTimer timer;
   timer.start();
   log_debug("Begin phase");
+  benchmark_stage_start();
 
   conn_list_do_buffer(game.est_connections);
+  conn_list_compression_freeze(game.est_connections);
 
   phase_players_iterate(pplayer)
   {
@@ -1207,6 +1207,7 @@ void begin_phase(bool is_new_phase)
     }
     conn_list_iterate_end;
   }
+  benchmark_stage_done("begin_phase: send players");
 
   // Must be the first thing as it is needed for lots of functions below!
   phase_players_iterate(pplayer)
@@ -1216,6 +1217,7 @@ void begin_phase(bool is_new_phase)
     CALL_PLR_AI_FUNC(phase_begin, pplayer, pplayer, is_new_phase);
   }
   phase_players_iterate_end;
+  benchmark_stage_done("begin_phase: ai");
 
   if (is_new_phase) {
     /* Unit "end of turn" activities - of course these actually go at
@@ -1279,6 +1281,7 @@ void begin_phase(bool is_new_phase)
     phase_players_iterate_end;
     flush_packets();
   }
+  benchmark_stage_done("begin_phase: unit activities");
 
   phase_players_iterate(pplayer)
   {
@@ -1293,8 +1296,12 @@ void begin_phase(bool is_new_phase)
   phase_players_iterate(pplayer) { send_player_cities(pplayer); }
   phase_players_iterate_end;
 
+  /* Compress what was queued for all the connections at once, and wait
+   * for it to be handed over before going on. */
+  conn_list_compression_thaw(game.est_connections);
   flush_packets(); // to curb major city spam
   conn_list_do_unbuffer(game.est_connections);
+  benchmark_stage_done("begin_phase: send cities");
 
   alive_phase_players_iterate(pplayer)
   {
@@ -1302,6 +1309,7 @@ void begin_phase(bool is_new_phase)
     update_capital(pplayer);
   }
   alive_phase_players_iterate_end;
+  benchmark_stage_done("begin_phase: governments");
 
   if (is_new_phase) {
     // Try to avoid hiding events under a diplomacy dialog
@@ -1324,6 +1332,7 @@ void begin_phase(bool is_new_phase)
     }
     phase_players_iterate_end;
   }
+  benchmark_stage_done("begin_phase: ai");
 
   sanity_check();
 
@@ -1341,6 +1350,7 @@ void begin_phase(bool is_new_phase)
      * will be responsive again */
     lsend_packet_begin_turn(game.est_connections);
   }
+  benchmark_stage_done("begin_phase: other");
   log_time(
       QStringLiteral("Start phase:%1 milliseconds").arg(timer.elapsed()));
 }
@@ -1354,6 +1364,7 @@ void end_phase()
   QElapsedTimer timer;
   timer.start();
   log_debug("Endphase");
+  benchmark_stage_start();
 
   /*
    * This empties the client Messages window; put this before
@@ -1420,6 +1431,8 @@ void end_phase()
   }
   phase_players_iterate_end;
 
+  benchmark_stage_done("end_phase: policies and research");
+
   // Freeze sending of cities.
   send_city_suppression(true);
 
@@ -1441,6 +1454,7 @@ void end_phase()
     }
   }
   phase_players_iterate_end;
+  benchmark_stage_done("end_phase: ai");
 
   // Refresh cities
   phase_players_iterate(pplayer)
@@ -1473,12 +1487,15 @@ void end_phase()
     flush_packets();
   }
   alive_phase_players_iterate_end;
+  benchmark_stage_done("end_phase: cities");
 
   /* Some player/global effect may have changed cities' vision range */
   phase_players_iterate(pplayer) { refresh_player_cities_vision(pplayer); }
   phase_players_iterate_end;
+  benchmark_stage_done("end_phase: vision");
 
   kill_dying_players();
+  benchmark_stage_done("end_phase: dying players");
 
   // Unfreeze sending of cities.
   send_city_suppression(false);
@@ -1486,10 +1503,12 @@ void end_phase()
   phase_players_iterate(pplayer) { send_player_cities(pplayer); }
   phase_players_iterate_end;
   flush_packets(); // to curb major city spam
+  benchmark_stage_done("end_phase: send cities");
 
   do_reveal_effects();
   do_have_contacts_effect();
   do_border_vision_effect();
+  benchmark_stage_done("end_phase: vision");
 
   phase_players_iterate(pplayer)
   {
@@ -1500,6 +1519,7 @@ void end_phase()
     adv_data_phase_done(pplayer);
   }
   phase_players_iterate_end;
+  benchmark_stage_done("end_phase: ai");
   log_time(QStringLiteral("End phase:%1 milliseconds").arg(timer.elapsed()));
 }
 
@@ -1513,6 +1533,7 @@ void end_turn()
   QElapsedTimer timer;
   timer.start();
   log_debug("Endturn");
+  benchmark_stage_start();
 
   /* Hack: because observer players never get an end-phase packet we send
    * one here. */
@@ -1527,6 +1548,7 @@ void end_turn()
   lsend_packet_end_turn(game.est_connections);
 
   map_calculate_borders();
+  benchmark_stage_done("end_turn: borders");
 
   // Output some AI measurement information
   players_iterate(pplayer)
@@ -1560,6 +1582,7 @@ void end_turn()
   log_debug("Season of native unrests");
   summon_barbarians(); /* wild guess really, no idea where to put it, but
                         * I want to give them chance to move their units */
+  benchmark_stage_done("end_turn: barbarians");
 
   if (game.server.migration) {
     log_debug("Season of migrations");
@@ -1577,8 +1600,10 @@ void end_turn()
       players_iterate_end;
     }
   }
+  benchmark_stage_done("end_turn: migration");
 
   check_disasters();
+  benchmark_stage_done("end_turn: disasters");
 
   /* Check for new achievements during the turn.
    * This is not within phase, as multiple players may
@@ -1626,6 +1651,7 @@ void end_turn()
     player_list_destroy(achievers);
   }
   achievements_iterate_end;
+  benchmark_stage_done("end_turn: achievements");
 
   if (game.info.global_warming) {
     update_environmental_upset(
@@ -1713,6 +1739,7 @@ void end_turn()
     whole_map_iterate_end;
   }
   extra_type_by_cause_iterate_end;
+  benchmark_stage_done("end_turn: environment and extras");
 
   update_diplomatics();
   make_history_report();
@@ -1720,6 +1747,7 @@ void end_turn()
   stdinhand_turn();
   voting_turn();
   send_city_turn_notifications(NULL);
+  benchmark_stage_done("end_turn: reports and settings");
 
   log_debug("Gamenextyear");
   game_advance_year();
@@ -1741,6 +1769,7 @@ void end_turn()
 
   log_debug("Sendyeartoclients");
   send_year_to_clients();
+  benchmark_stage_done("end_turn: send info");
   log_time(QStringLiteral("End turn:%1 milliseconds").arg(timer.elapsed()));
 }
 
@@ -3000,6 +3029,9 @@ void srv_ready()
     }
   }
 
+  // Extras of generated and loaded maps are not set tile by tile.
+  map_count_extras(&(wld.map));
+
   CALL_FUNC_EACH_AI(map_ready);
 
   // start the game
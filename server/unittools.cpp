@@ -16,6 +16,7 @@
 #endif
 
 #include <QDateTime>
+#include <QHash>
 
 #include <cstdio>
 #include <cstdlib>
@@ -3612,13 +3613,12 @@ static struct unit_move_data *unit_move_data(struct unit *punit,
 {
   struct unit_move_data *pdata;
   struct player *powner = unit_owner(punit);
-  const v_radius_t radius_sq =
-      V_RADIUS(get_unit_vision_at(punit, pdesttile, V_MAIN),
-               get_unit_vision_at(punit, pdesttile, V_INVIS),
-               get_unit_vision_at(punit, pdesttile, V_SUBSURFACE));
+  v_radius_t radius_sq;
   struct vision *new_vision;
   bool success;
 
+  get_unit_vision_radius_at(punit, pdesttile, radius_sq);
+
   if (punit->server.moving) {
     // Recursive moving (probably due to a script).
     pdata = punit->server.moving;
@@ -4614,19 +4614,23 @@ bool execute_orders(struct unit *punit, const bool fresh)
 }
 
 /**
-   Return the vision the unit will have at the given tile.  The base vision
-   range may be modified by effects.
+   Return the base vision radius of the unit at the given tile, before it
+   is adjusted for a layer. This is where the effects are evaluated.
+ */
+static int unit_base_vision_at(struct unit *punit, const struct tile *ptile)
+{
+  return (unit_type_get(punit)->vision_radius_sq
+          + get_unittype_bonus(unit_owner(punit), ptile,
+                               unit_type_get(punit),
+                               EFT_UNIT_VISION_RADIUS_SQ));
+}
 
-   Note that vision MUST be independent of transported_by for this to work
-   properly.
+/**
+   Return the vision radius on the given layer for a unit with the given
+   base vision radius.
  */
-int get_unit_vision_at(struct unit *punit, const struct tile *ptile,
-                       enum vision_layer vlayer)
+static int unit_layer_vision(int base, enum vision_layer vlayer)
 {
-  const int base =
-      (unit_type_get(punit)->vision_radius_sq
-       + get_unittype_bonus(unit_owner(punit), ptile, unit_type_get(punit),
-                            EFT_UNIT_VISION_RADIUS_SQ));
   switch (vlayer) {
   case V_MAIN:
     return MAX(0, base);
@@ -4642,30 +4646,86 @@ int get_unit_vision_at(struct unit *punit, const struct tile *ptile,
 }
 
 /**
-   Refresh the unit's vision.
+   Return the vision the unit will have at the given tile.  The base vision
+   range may be modified by effects.
 
-   This function has very small overhead and can be called any time effects
-   may have changed the vision range of the city.
+   Note that vision MUST be independent of transported_by for this to work
+   properly.
  */
-void unit_refresh_vision(struct unit *punit)
+int get_unit_vision_at(struct unit *punit, const struct tile *ptile,
+                       enum vision_layer vlayer)
+{
+  return unit_layer_vision(unit_base_vision_at(punit, ptile), vlayer);
+}
+
+/**
+   Fill radius_sq with the vision the unit will have at the given tile on
+   all layers. Cheaper than calling get_unit_vision_at() for each layer, as
+   the effects are only evaluated once.
+ */
+void get_unit_vision_radius_at(struct unit *punit, const struct tile *ptile,
+                               v_radius_t radius_sq)
+{
+  int base = unit_base_vision_at(punit, ptile);
+
+  vision_layer_iterate(v) { radius_sq[v] = unit_layer_vision(base, v); }
+  vision_layer_iterate_end;
+}
+
+/**
+   Apply the vision radius of the unit computed from the given base
+   radius. The current radius kept in the vision works as a cache: if
+   nothing changed, no tile is visited, and otherwise only the ring
+   between the old and new radius is updated.
+ */
+static void unit_apply_base_vision(struct unit *punit, int base)
 {
   struct vision *uvision = punit->server.vision;
-  const struct tile *utile = unit_tile(punit);
-  const v_radius_t radius_sq =
-      V_RADIUS(get_unit_vision_at(punit, utile, V_MAIN),
-               get_unit_vision_at(punit, utile, V_INVIS),
-               get_unit_vision_at(punit, utile, V_SUBSURFACE));
+  v_radius_t radius_sq;
+
+  vision_layer_iterate(v) { radius_sq[v] = unit_layer_vision(base, v); }
+  vision_layer_iterate_end;
 
   vision_change_sight(uvision, radius_sq);
   ASSERT_VISION(uvision);
 }
 
+/**
+   Refresh the unit's vision.
+
+   This function has very small overhead and can be called any time effects
+   may have changed the vision range of the city.
+ */
+void unit_refresh_vision(struct unit *punit)
+{
+  unit_apply_base_vision(punit,
+                         unit_base_vision_at(punit, unit_tile(punit)));
+}
+
 /**
    Refresh the vision of all units in the list - see unit_refresh_vision.
+
+   The vision effects only depend on the owner, the unit type and the tile,
+   so they are evaluated once for all the units sharing them (e.g. in
+   stacks or in cities).
  */
 void unit_list_refresh_vision(struct unit_list *punitlist)
 {
-  unit_list_iterate(punitlist, punit) { unit_refresh_vision(punit); }
+  QHash<quint64, int> base_vision;
+
+  unit_list_iterate(punitlist, punit)
+  {
+    const struct tile *utile = unit_tile(punit);
+    quint64 key = ((quint64) player_index(unit_owner(punit)) << 48)
+                  | ((quint64) utype_index(unit_type_get(punit)) << 32)
+                  | (quint64) tile_index(utile);
+    auto it = base_vision.constFind(key);
+
+    if (it == base_vision.constEnd()) {
+      it = base_vision.insert(key, unit_base_vision_at(punit, utile));
+    }
+    unit_apply_base_vision(punit, it.value());
+  }
   unit_list_iterate_end;
 }
 
@@ -107,6 +107,8 @@ void remove_allied_visibility(struct player *pplayer, struct player *aplayer,
 void give_allied_visibility(struct player *pplayer, struct player *aplayer);
 int get_unit_vision_at(struct unit *punit, const struct tile *ptile,
                        enum vision_layer vlayer);
+void get_unit_vision_radius_at(struct unit *punit, const struct tile *ptile,
+                               v_radius_t radius_sq);
 void unit_refresh_vision(struct unit *punit);
 void unit_list_refresh_vision(struct unit_list *punitlist);
 void bounce_unit(struct unit *punit, bool verbose);
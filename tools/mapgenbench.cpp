@@ -0,0 +1,352 @@
+/*__            ___                 ***************************************
+/   \          /   \          Copyright (c) 1996-2020 Freeciv21 and Freeciv
+\_   \        /  __/          contributors. This file is part of Freeciv21.
+ _\   \      /  /__     Freeciv21 is free software: you can redistribute it
+ \___  \____/   __/    and/or modify it under the terms of the GNU  General
+     \_       _/          Public License  as published by the Free Software
+       | @ @  \_               Foundation, either version 3 of the  License,
+       |                              or (at your option) any later version.
+     _/     /\                  You should have received  a copy of the GNU
+    /o)  (o/\ \_                General Public License along with Freeciv21.
+    \_____/ /                     If not, see https://www.gnu.org/licenses/.
+      \____/        ********************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <algorithm>
+#include <vector>
+
+// Qt
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+
+// utility
+#include "fciconv.h"
+#include "fcintl.h"
+#include "log.h"
+#include "timing.h"
+
+// common
+#include "fc_interface.h"
+#include "game.h"
+#include "map.h"
+#include "player.h"
+
+// server
+#include "aiiface.h"
+#include "gamehand.h"
+#include "plrhand.h"
+#include "ruleset.h"
+#include "sernet.h"
+#include "settings.h"
+
+/* server/generator */
+#include "mapgen.h"
+
+/* tools/shared */
+#include "tools_fc_interface.h"
+
+static QString rs_selected;
+static QList<int> seeds = {1, 2, 3};
+static QList<int> sizes = {4};
+static QList<enum map_generator> generators = {
+    MAPGEN_RANDOM, MAPGEN_FRACTAL, MAPGEN_ISLAND, MAPGEN_FAIR,
+    MAPGEN_FRACTURE};
+static int num_players = 8;
+
+static const struct {
+  const char *name;
+  enum map_generator generator;
+} generator_names[] = {{"random", MAPGEN_RANDOM},
+                       {"fractal", MAPGEN_FRACTAL},
+                       {"island", MAPGEN_ISLAND},
+                       {"fair", MAPGEN_FAIR},
+                       {"fracture", MAPGEN_FRACTURE}};
+
+/**
+   Returns the name of a map generator.
+ */
+static const char *generator_name(enum map_generator generator)
+{
+  for (const auto &entry : generator_names) {
+    if (entry.generator == generator) {
+      return entry.name;
+    }
+  }
+  return "scenario";
+}
+
+/**
+   Parses a comma separated list of positive integers. Exits on error.
+ */
+static QList<int> parse_int_list(const QString &option,
+                                 const QString &value)
+{
+  QList<int> list;
+
+  for (const auto &item : value.split(QLatin1Char(','))) {
+    bool ok;
+    int number = item.toInt(&ok);
+
+    if (!ok || number <= 0) {
+      fc_fprintf(stderr, _("Invalid value \"%s\" for --%s.\n"),
+                 qUtf8Printable(item), qUtf8Printable(option));
+      exit(EXIT_FAILURE);
+    }
+    list.append(number);
+  }
+  return list;
+}
+
+/**
+   Parse freeciv21-mapgen-bench commandline parameters.
+ */
+static void mgb_parse_cmdline(const QCoreApplication &app)
+{
+  QCommandLineParser parser;
+  parser.addHelpOption();
+  parser.addVersionOption();
+
+  bool ok = parser.addOptions({
+      {{"d", _("debug")},
+       // TRANS: Do not translate "fatal", "critical", "warning", "info" or
+       //        "debug". It's exactly what the user must type.
+       _("Set debug log level (fatal/critical/warning/info/debug)"),
+       _("LEVEL"),
+       QStringLiteral("warning")},
+      {{"F", "Fatal"}, _("Raise a signal on failed assertion")},
+      {{"r", "ruleset"},
+       _("Generate maps for RULESET"),
+       // TRANS: Command-line argument
+       _("RULESET")},
+      {{"s", "seeds"},
+       _("Comma separated list of map seeds"),
+       // TRANS: Command-line argument
+       _("SEEDS")},
+      {{"z", "sizes"},
+       _("Comma separated list of map sizes, in thousands of tiles"),
+       // TRANS: Command-line argument
+       _("SIZES")},
+      {{"g", "generators"},
+       _("Comma separated list of generators "
+         "(random/fractal/island/fair/fracture)"),
+       // TRANS: Command-line argument
+       _("GENERATORS")},
+      {{"p", "players"},
+       _("Number of players to generate start positions for"),
+       // TRANS: Command-line argument
+       _("NUMBER")},
+  });
+  if (!ok) {
+    qFatal("Adding command line arguments failed");
+    exit(EXIT_FAILURE);
+  }
+
+  // Parse
+  parser.process(app);
+
+  // Process the parsed options
+  if (!log_init(parser.value(QStringLiteral("debug")))) {
+    exit(EXIT_FAILURE);
+  }
+  fc_assert_set_fatal(parser.isSet(QStringLiteral("Fatal")));
+  if (parser.isSet(QStringLiteral("ruleset"))) {
+    rs_selected = parser.value(QStringLiteral("ruleset"));
+  }
+  if (parser.isSet(QStringLiteral("seeds"))) {
+    seeds = parse_int_list(QStringLiteral("seeds"),
+                           parser.value(QStringLiteral("seeds")));
+  }
+  if (parser.isSet(QStringLiteral("sizes"))) {
+    sizes = parse_int_list(QStringLiteral("sizes"),
+                           parser.value(QStringLiteral("sizes")));
+  }
+  if (parser.isSet(QStringLiteral("players"))) {
+    num_players = parse_int_list(QStringLiteral("players"),
+                                 parser.value(QStringLiteral("players")))
+                      .first();
+  }
+  if (parser.isSet(QStringLiteral("generators"))) {
+    generators.clear();
+    for (const auto &name :
+         parser.value(QStringLiteral("generators")).split(',')) {
+      bool found = false;
+
+      for (const auto &entry : generator_names) {
+        if (name == QLatin1String(entry.name)) {
+          generators.append(entry.generator);
+          found = true;
+        }
+      }
+      if (!found) {
+        fc_fprintf(stderr, _("Unknown map generator \"%s\".\n"),
+                   qUtf8Printable(name));
+        exit(EXIT_FAILURE);
+      }
+    }
+  }
+}
+
+/**
+   Returns a hash of everything the generator produced: the terrain,
+   resource and extras of each tile, and the start positions.
+ */
+static QByteArray map_hash()
+{
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  std::vector<int> startpos_tiles;
+
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    const struct extra_type *presource = tile_resource(ptile);
+    qint32 data[2] = {terrain_number(tile_terrain(ptile)),
+                      presource != NULL ? extra_number(presource) : -1};
+
+    hash.addData(reinterpret_cast<const char *>(data), sizeof(data));
+    hash.addData(reinterpret_cast<const char *>(tile_extras(ptile)->vec),
+                 sizeof(tile_extras(ptile)->vec));
+  }
+  whole_map_iterate_end;
+
+  for (auto *psp : qAsConst(*wld.map.startpos_table)) {
+    startpos_tiles.push_back(tile_index(startpos_tile(psp)));
+  }
+  std::sort(startpos_tiles.begin(), startpos_tiles.end());
+  hash.addData(reinterpret_cast<const char *>(startpos_tiles.data()),
+               startpos_tiles.size() * sizeof(int));
+
+  return hash.result().toHex();
+}
+
+/**
+   Returns the unit type start positions are evaluated for, as the server
+   would choose it.
+ */
+static struct unit_type *initial_unit_type()
+{
+  struct unit_type *utype = NULL;
+  int sucount = qstrlen(game.server.start_units);
+  int i;
+
+  for (i = 0; utype == NULL && i < sucount; i++) {
+    utype = crole_to_unit_type(game.server.start_units[i], NULL);
+  }
+  if (utype == NULL) {
+    // First unit the initial city might build.
+    utype = get_role_unit(L_FIRSTBUILD, 0);
+  }
+  return utype;
+}
+
+/**
+   Generates one map and prints its timings and hash. Returns FALSE if the
+   generator failed.
+ */
+static bool run_one(enum map_generator generator, int seed, int size,
+                    struct unit_type *utype)
+{
+  civtimer *timer = timer_new(TIMER_USER, TIMER_ACTIVE);
+  bool created;
+
+  if (!map_is_empty()) {
+    main_map_free();
+    free_city_map_index();
+  }
+
+  wld.map.server.generator = generator;
+  wld.map.server.seed_setting = seed;
+  wld.map.server.mapsize = MAPSIZE_FULLSIZE;
+  wld.map.server.size = size;
+  wld.map.server.have_resources = false;
+  wld.map.server.have_huts = false;
+
+  timer_start(timer);
+  created = map_fractal_generate(true, utype);
+  timer_stop(timer);
+
+  /* The generator falls back to another one when it fails, report the
+   * one that was actually used. */
+  fc_printf("%s seed=%d size=%d map=%dx%d used=%s total=%.3fs hash=%s\n",
+            generator_name(generator), seed, size, wld.map.xsize,
+            wld.map.ysize, generator_name(wld.map.server.generator),
+            timer_read_seconds(timer),
+            created ? map_hash().constData() : "failed");
+  for (const auto &pass : mapgen_last_pass_times()) {
+    fc_printf("  %-26s %.3fs\n", qUtf8Printable(pass.first), pass.second);
+  }
+  timer_destroy(timer);
+
+  return created;
+}
+
+/**
+   Main entry point for freeciv21-mapgen-bench
+ */
+int main(int argc, char **argv)
+{
+  int retval = EXIT_SUCCESS;
+  struct unit_type *utype;
+  int i;
+
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationVersion(VERSION_STRING);
+
+  init_nls();
+  init_character_encodings(FC_DEFAULT_DATA_ENCODING, false);
+
+  mgb_parse_cmdline(app);
+
+  init_connections();
+  settings_init(false);
+  game_init(false);
+  i_am_tool();
+
+  // Initialize the fc_interface functions needed to understand rules.
+  fc_interface_init_tool();
+  ai_init();
+
+  // Set ruleset user requested to use
+  if (rs_selected.isEmpty()) {
+    rs_selected = GAME_DEFAULT_RULESETDIR;
+  }
+  sz_strlcpy(game.server.rulesetdir, qUtf8Printable(rs_selected));
+
+  if (!load_rulesets(NULL, NULL, false, NULL, true, false, true)) {
+    qCritical(_("Can't load ruleset %s"), qUtf8Printable(rs_selected));
+    log_close();
+    free_libfreeciv();
+    free_nls();
+    return EXIT_FAILURE;
+  }
+
+  // Start positions and fair islands depend on the number of players.
+  for (i = 0; i < num_players; i++) {
+    struct player *pplayer =
+        server_create_player(-1, default_ai_type_name(), NULL, false);
+
+    fc_assert_action(pplayer != NULL, break);
+    server_player_init(pplayer, false, true);
+  }
+
+  utype = initial_unit_type();
+  fc_assert_ret_val(utype != NULL, EXIT_FAILURE);
+
+  for (const auto generator : qAsConst(generators)) {
+    for (const auto size : qAsConst(sizes)) {
+      for (const auto seed : qAsConst(seeds)) {
+        if (!run_one(generator, seed, size, utype)) {
+          retval = EXIT_FAILURE;
+        }
+      }
+    }
+  }
+
+  log_close();
+  free_libfreeciv();
+  free_nls();
+
+  return retval;
+}
@@ -0,0 +1,346 @@
+/*__            ___                 ***************************************
+/   \          /   \          Copyright (c) 1996-2020 Freeciv21 and Freeciv
+\_   \        /  __/          contributors. This file is part of Freeciv21.
+ _\   \      /  /__     Freeciv21 is free software: you can redistribute it
+ \___  \____/   __/    and/or modify it under the terms of the GNU  General
+     \_       _/          Public License  as published by the Free Software
+       | @ @  \_               Foundation, either version 3 of the  License,
+       |                              or (at your option) any later version.
+     _/     /\                  You should have received  a copy of the GNU
+    /o)  (o/\ \_                General Public License along with Freeciv21.
+    \_____/ /                     If not, see https://www.gnu.org/licenses/.
+      \____/        ********************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#include <cmath>
+
+// Qt
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+// utility
+#include "fciconv.h"
+#include "fcintl.h"
+#include "log.h"
+#include "timing.h"
+
+// common
+#include "fc_interface.h"
+#include "game.h"
+#include "map.h"
+
+static int xsize = 512;
+static int ysize = 256;
+static int rounds = 10;
+static int square_radius = 2;
+static int circle_sq_radius = 5;
+
+/* The functions named old_* iterate the way the map.h macros did before
+ * the neighbour table and the inner tile fast path: every tile goes
+ * through map_pos_to_tile(), with wrapping and normalization. */
+
+/**
+   Sums the indices of the tiles adjacent to each tile, stepping and
+   normalizing for every neighbour.
+ */
+static long long old_adjc()
+{
+  long long sum = 0;
+
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    int cx, cy;
+
+    index_to_map_pos(&cx, &cy, tile_index(ptile));
+    for (int i = 0; i < wld.map.num_valid_dirs; i++) {
+      int x, y;
+      struct tile *adjc;
+
+      DIRSTEP(x, y, wld.map.valid_dirs[i]);
+      adjc = map_pos_to_tile(&(wld.map), x + cx, y + cy);
+      if (adjc != NULL) {
+        sum += tile_index(adjc);
+      }
+    }
+  }
+  whole_map_iterate_end;
+
+  return sum;
+}
+
+/**
+   Sums the indices of the tiles adjacent to each tile with adjc_iterate.
+ */
+static long long new_adjc()
+{
+  long long sum = 0;
+
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    adjc_iterate(&(wld.map), ptile, adjc) { sum += tile_index(adjc); }
+    adjc_iterate_end;
+  }
+  whole_map_iterate_end;
+
+  return sum;
+}
+
+/**
+   Sums the indices of the tiles within real distance max_dist of each
+   tile, and within squared distance max_sq_dist when it isn't negative,
+   normalizing every position.
+ */
+static long long old_outward(int max_dist, int max_sq_dist)
+{
+  long long sum = 0;
+
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    int sx, sy;
+
+    index_to_map_pos(&sx, &sy, tile_index(ptile));
+    for (int i = 0; i < wld.map.num_iterate_outwards_indices; i++) {
+      const auto &offset = wld.map.iterate_outwards_indices[i];
+      struct tile *itr;
+
+      if (offset.dist > max_dist) {
+        break;
+      }
+      itr = map_pos_to_tile(&(wld.map), sx + offset.dx, sy + offset.dy);
+      if (itr != NULL
+          && (max_sq_dist < 0
+              || map_vector_to_sq_distance(offset.dx, offset.dy)
+                     <= max_sq_dist)) {
+        sum += tile_index(itr);
+      }
+    }
+  }
+  whole_map_iterate_end;
+
+  return sum;
+}
+
+/**
+   old_outward() for a square.
+ */
+static long long old_square() { return old_outward(square_radius, -1); }
+
+/**
+   Sums the indices of the tiles in the square around each tile with
+   square_iterate.
+ */
+static long long new_square()
+{
+  long long sum = 0;
+
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    square_iterate(&(wld.map), ptile, square_radius, itr)
+    {
+      sum += tile_index(itr);
+    }
+    square_iterate_end;
+  }
+  whole_map_iterate_end;
+
+  return sum;
+}
+
+/**
+   old_outward() for a circle.
+ */
+static long long old_circle()
+{
+  return old_outward(static_cast<int>(sqrt(circle_sq_radius)),
+                     circle_sq_radius);
+}
+
+/**
+   Sums the indices of the tiles in the circle around each tile with
+   circle_iterate.
+ */
+static long long new_circle()
+{
+  long long sum = 0;
+
+  whole_map_iterate(&(wld.map), ptile)
+  {
+    circle_iterate(&(wld.map), ptile, circle_sq_radius, itr)
+    {
+      sum += tile_index(itr);
+    }
+    circle_iterate_end;
+  }
+  whole_map_iterate_end;
+
+  return sum;
+}
+
+/**
+   Runs func the configured number of rounds. Returns the CPU time it took
+   and stores the checksum of the last round in sum.
+ */
+static double time_rounds(long long (*func)(), long long *sum)
+{
+  civtimer *timer = timer_new(TIMER_USER, TIMER_ACTIVE);
+  double seconds;
+
+  timer_start(timer);
+  for (int i = 0; i < rounds; i++) {
+    *sum = func();
+  }
+  timer_stop(timer);
+  seconds = timer_read_seconds(timer);
+  timer_destroy(timer);
+
+  return seconds;
+}
+
+/**
+   Times the old and new iteration of one kind and prints the result.
+   Returns FALSE if they didn't visit the same tiles.
+ */
+static bool compare(const char *name, long long (*old_func)(),
+                    long long (*new_func)())
+{
+  long long old_sum = 0, new_sum = 0;
+  double old_time = time_rounds(old_func, &old_sum);
+  double new_time = time_rounds(new_func, &new_sum);
+
+  fc_printf("%-8s old %8.3fs new %8.3fs speedup %5.2fx%s\n", name,
+            old_time, new_time, new_time > 0 ? old_time / new_time : 0.0,
+            old_sum == new_sum ? "" : " MISMATCH");
+
+  return old_sum == new_sum;
+}
+
+/**
+   Parses an integer option that must be at least min. Exits on error.
+ */
+static int parse_int(const QCommandLineParser &parser,
+                     const QString &option, int min)
+{
+  bool ok;
+  int number = parser.value(option).toInt(&ok);
+
+  if (!ok || number < min) {
+    fc_fprintf(stderr, _("Invalid value \"%s\" for --%s.\n"),
+               qUtf8Printable(parser.value(option)),
+               qUtf8Printable(option));
+    exit(EXIT_FAILURE);
+  }
+  return number;
+}
+
+/**
+   Parse freeciv21-map-iter-bench commandline parameters.
+ */
+static void mib_parse_cmdline(const QCoreApplication &app)
+{
+  QCommandLineParser parser;
+  parser.addHelpOption();
+  parser.addVersionOption();
+
+  bool ok = parser.addOptions({
+      {{"d", _("debug")},
+       // TRANS: Do not translate "fatal", "critical", "warning", "info" or
+       //        "debug". It's exactly what the user must type.
+       _("Set debug log level (fatal/critical/warning/info/debug)"),
+       _("LEVEL"),
+       QStringLiteral("warning")},
+      {{"F", "Fatal"}, _("Raise a signal on failed assertion")},
+      {{"x", "xsize"},
+       _("Width of the map"),
+       // TRANS: Command-line argument
+       _("NUMBER")},
+      {{"y", "ysize"},
+       _("Height of the map"),
+       // TRANS: Command-line argument
+       _("NUMBER")},
+      {{"n", "rounds"},
+       _("Number of times each iteration is run over the whole map"),
+       // TRANS: Command-line argument
+       _("NUMBER")},
+      {{"s", "square"},
+       _("Radius of the squares"),
+       // TRANS: Command-line argument
+       _("NUMBER")},
+      {{"c", "circle"},
+       _("Squared radius of the circles"),
+       // TRANS: Command-line argument
+       _("NUMBER")},
+  });
+  if (!ok) {
+    qFatal("Adding command line arguments failed");
+    exit(EXIT_FAILURE);
+  }
+
+  // Parse
+  parser.process(app);
+
+  // Process the parsed options
+  if (!log_init(parser.value(QStringLiteral("debug")))) {
+    exit(EXIT_FAILURE);
+  }
+  fc_assert_set_fatal(parser.isSet(QStringLiteral("Fatal")));
+  if (parser.isSet(QStringLiteral("xsize"))) {
+    xsize = parse_int(parser, QStringLiteral("xsize"), MAP_MIN_LINEAR_SIZE);
+  }
+  if (parser.isSet(QStringLiteral("ysize"))) {
+    ysize = parse_int(parser, QStringLiteral("ysize"), MAP_MIN_LINEAR_SIZE);
+  }
+  if (parser.isSet(QStringLiteral("rounds"))) {
+    rounds = parse_int(parser, QStringLiteral("rounds"), 1);
+  }
+  if (parser.isSet(QStringLiteral("square"))) {
+    square_radius = parse_int(parser, QStringLiteral("square"), 0);
+  }
+  if (parser.isSet(QStringLiteral("circle"))) {
+    circle_sq_radius = parse_int(parser, QStringLiteral("circle"), 0);
+  }
+}
+
+/**
+   Main entry point for freeciv21-map-iter-bench. Compares the map
+   iteration of the map.h macros with the iteration they replaced, on a
+   plain map that wraps in x.
+ */
+int main(int argc, char **argv)
+{
+  bool same;
+
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationVersion(VERSION_STRING);
+
+  init_nls();
+  init_character_encodings(FC_DEFAULT_DATA_ENCODING, false);
+
+  mib_parse_cmdline(app);
+
+  game_init(false);
+  i_am_tool();
+
+  wld.map.topology_id = TF_WRAPX;
+  wld.map.xsize = xsize;
+  wld.map.ysize = ysize;
+  map_init_topology();
+  main_map_allocate();
+
+  fc_printf("map %dx%d wrapx, %d rounds, square radius %d, "
+            "circle squared radius %d\n",
+            wld.map.xsize, wld.map.ysize, rounds, square_radius,
+            circle_sq_radius);
+  same = compare("adjc", old_adjc, new_adjc);
+  same = compare("square", old_square, new_square) && same;
+  same = compare("circle", old_circle, new_circle) && same;
+
+  game_free();
+  log_close();
+  free_libfreeciv();
+  free_nls();
+
+  return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
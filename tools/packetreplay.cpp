@@ -0,0 +1,67 @@
+/*__            ___                 ***************************************
+/   \          /   \          Copyright (c) 1996-2020 Freeciv21 and Freeciv
+\_   \        /  __/          contributors. This file is part of Freeciv21.
+ _\   \      /  /__     Freeciv21 is free software: you can redistribute it
+ \___  \____/   __/    and/or modify it under the terms of the GNU  General
+     \_       _/          Public License  as published by the Free Software
+       | @ @  \_               Foundation, either version 3 of the  License,
+       |                              or (at your option) any later version.
+     _/     /\                  You should have received  a copy of the GNU
+    /o)  (o/\ \_                General Public License along with Freeciv21.
+    \_____/ /                     If not, see https://www.gnu.org/licenses/.
+      \____/        ********************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include <fc_config.h>
+#endif
+
+#ifdef AUDIO_SDL
+#include <SDL2/SDL.h>
+#endif // AUDIO_SDL
+
+#include <vector>
+
+// Qt
+#include <QtGlobal>
+
+// utility
+#include "fciconv.h"
+#include "fcintl.h"
+
+// client
+#include "client_main.h"
+#include "gui_cbsetter.h"
+
+/**
+   Main entry point for freeciv21-packet-replay. It runs the client on
+   Qt's offscreen platform, so no display is needed, and replays the data
+   recorded by "freeciv21-client --record FILE":
+
+     freeciv21-packet-replay FILE [client options]
+
+   The client handles the recorded packets as if they came from a server,
+   prints how many packets were handled, how many GUI updates they
+   requested and ran, and how long it took, then exits.
+ */
+int main(int argc, char **argv)
+{
+  static char replay_option[] = "--replay";
+  std::vector<char *> client_argv;
+
+  if (argc < 2 || argv[1][0] == '-') {
+    fc_fprintf(stderr, _("Usage: %s FILE [client options]\n"), argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+
+  client_argv.push_back(argv[0]);
+  client_argv.push_back(replay_option);
+  client_argv.insert(client_argv.end(), argv + 1, argv + argc);
+  client_argv.push_back(nullptr);
+
+  setup_gui_funcs();
+  return client_main(client_argv.size() - 1, client_argv.data());
+}
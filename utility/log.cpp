@@ -18,17 +18,24 @@
 #include <iostream>
 
 #include <csignal>
+#include <cstdlib>
 #include <cstdarg>
 #include <cstdio>
 #include <cstring>
+#include <utility>
 #include <vector>
 
 // Qt
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFileInfo>
+#include <QHash>
 #include <QLoggingCategory>
 #include <QMutexLocker>
+#include <QPair>
 #include <QString>
+#include <QStringList>
+#include <QWaitCondition>
 
 // Windows
 #ifdef Q_OS_WIN
@@ -54,8 +61,29 @@ static bool fatal_assertions = false;
 static QBasicMutex mutex;
 static void handle_message(QtMsgType type, const QMessageLogContext &context,
                            const QString &message);
+static void log_writer_start();
 static QtMessageHandler original_handler = nullptr;
 static QFile *log_file = nullptr;
+
+/* Lines for the log file are handed to a writer thread, so that verbose
+ * logging doesn't block the caller on file I/O. */
+struct log_writer {
+  QMutex mutex;
+  QWaitCondition wake;    // New lines or stop request
+  QWaitCondition drained; // Everything queued so far has been written
+  QStringList pending;
+  bool busy = false;
+  bool stop = false;
+  fcThread *thread = nullptr;
+
+  /* Rate limiting, see rate_limited(). A call site is the file and line
+   * of the message, or its category and -1 when the location is
+   * unknown. */
+  QMutex rate_mutex;
+  QElapsedTimer window;
+  QHash<QPair<const void *, int>, int> counts;
+};
+Q_GLOBAL_STATIC(log_writer, writer)
 } // anonymous namespace
 
 /**
@@ -70,6 +98,7 @@ bool log_init(const QString &level_str)
 
   // Install our handler
   original_handler = qInstallMessageHandler(&handle_message);
+  log_writer_start();
 
 #ifdef Q_OS_WIN
   {
@@ -142,30 +171,251 @@ bool log_init(const QString &level_str)
   }
 }
 
+namespace {
+// At most this many messages per call site and window are logged...
+constexpr int LOG_RATE_LIMIT = 100;
+// ...where a window lasts this many milliseconds.
+constexpr qint64 LOG_RATE_WINDOW = 1000;
+
 /**
-   Prints a message, handling Freeciv-specific stuff before passing to
-   the Qt handler.
+   Writes a batch of lines to the log file.
  */
-namespace {
-static void handle_message(QtMsgType type, const QMessageLogContext &context,
-                           const QString &message)
+static void write_lines(const QStringList &lines)
+{
+  QByteArray data;
+
+  for (const auto &line : lines) {
+    data += (line + QStringLiteral("\n")).toLocal8Bit();
+  }
+
+  QMutexLocker lock(&mutex);
+  if (log_file != nullptr) {
+    log_file->write(data);
+  }
+}
+
+/**
+   Main loop of the log writer thread.
+ */
+static void log_writer_run(void *)
+{
+  QMutexLocker locker(&writer->mutex);
+
+  while (true) {
+    while (writer->pending.isEmpty() && !writer->stop) {
+      writer->wake.wait(&writer->mutex);
+    }
+    if (writer->pending.isEmpty()) {
+      break; // Stop requested and nothing left to write
+    }
+
+    QStringList lines;
+    lines.swap(writer->pending);
+    writer->busy = true;
+    locker.unlock();
+
+    write_lines(lines);
+
+    locker.relock();
+    writer->busy = false;
+    writer->drained.wakeAll();
+  }
+}
+
+/**
+   Waits until the writer thread has written everything queued so far, then
+   flushes the log file.
+ */
+static void log_drain()
+{
+  if (writer->thread != nullptr
+      && QThread::currentThread() != writer->thread) {
+    QMutexLocker locker(&writer->mutex);
+
+    while (!writer->pending.isEmpty() || writer->busy) {
+      writer->wake.wakeOne();
+      writer->drained.wait(&writer->mutex);
+    }
+  }
+
+  QMutexLocker lock(&mutex);
+  if (log_file != nullptr) {
+    log_file->flush();
+  }
+}
+
+/**
+   Sends a message to the log file, through the writer thread when it
+   runs, and to the Qt handler.
+ */
+static void forward_message(QtMsgType type,
+                            const QMessageLogContext &context,
+                            const QString &message)
 {
   // Forward to file
   if (log_file != nullptr) {
-    QMutexLocker lock(&mutex);
-    log_file->write((message + QStringLiteral("\n")).toLocal8Bit());
+    if (!writer.isDestroyed() && writer->thread != nullptr
+        && QThread::currentThread() != writer->thread) {
+      QMutexLocker locker(&writer->mutex);
+      writer->pending.append(message);
+      writer->wake.wakeOne();
+    } else {
+      write_lines(QStringList(message));
+    }
 
     // Make sure we flush when it looks serious, maybe we'll crash soon
     if (type == QtFatalMsg || type == QtCriticalMsg) {
-      log_file->flush();
+      log_drain();
     }
   }
 
-  // Forward to the Qt handler
+  /* Forward to the Qt handler. This stays synchronous, so that what is
+   * printed before a crash is not lost and stays in order with the
+   * console. */
   if (original_handler != nullptr) {
     original_handler(type, context, message);
   }
 }
+
+/**
+   Returns a line telling how many messages were dropped for every call
+   site that went over the limit, and starts a new window. Must be called
+   with the rate mutex held.
+ */
+static QStringList flush_rate_limits()
+{
+  QStringList lines;
+
+  for (auto it = writer->counts.cbegin(); it != writer->counts.cend();
+       ++it) {
+    if (it.value() > LOG_RATE_LIMIT) {
+      const char *where = static_cast<const char *>(it.key().first);
+      QString site =
+          it.key().second >= 0
+              ? QStringLiteral("%1:%2").arg(where).arg(it.key().second)
+              : QString::fromUtf8(where);
+
+      lines.append(QStringLiteral("Dropped %1 more log messages from %2")
+                       .arg(it.value() - LOG_RATE_LIMIT)
+                       .arg(site));
+    }
+  }
+  writer->counts.clear();
+  writer->window.start();
+
+  return lines;
+}
+
+/**
+   Logs the lines returned by flush_rate_limits().
+ */
+static void report_rate_limits(const QStringList &lines)
+{
+  for (const auto &line : lines) {
+    forward_message(QtWarningMsg, QMessageLogContext(), line);
+  }
+}
+
+/**
+   Returns whether a message should be dropped because its call site
+   logged too much recently. The source location of messages is recorded
+   in all builds (QT_MESSAGELOGCONTEXT), so the file name and line tell
+   call sites apart without looking at the text. Critical and fatal
+   messages are never dropped.
+ */
+static bool rate_limited(QtMsgType type, const QMessageLogContext &context)
+{
+  QStringList dropped;
+  bool limited;
+
+  if (type == QtFatalMsg || type == QtCriticalMsg) {
+    return false;
+  }
+
+  {
+    QMutexLocker locker(&writer->rate_mutex);
+
+    if (!writer->window.isValid()
+        || writer->window.hasExpired(LOG_RATE_WINDOW)) {
+      dropped = flush_rate_limits();
+    }
+
+    auto site =
+        context.file != nullptr
+            ? qMakePair(static_cast<const void *>(context.file),
+                        context.line)
+            : qMakePair(static_cast<const void *>(context.category), -1);
+    limited = (++writer->counts[site] > LOG_RATE_LIMIT);
+  }
+
+  report_rate_limits(dropped);
+  return limited;
+}
+
+/**
+   Stops the writer thread after it has written all pending lines.
+ */
+static void log_writer_stop()
+{
+  if (writer.isDestroyed() || writer->thread == nullptr) {
+    return;
+  }
+
+  {
+    QMutexLocker locker(&writer->rate_mutex);
+    report_rate_limits(flush_rate_limits());
+  }
+  {
+    QMutexLocker locker(&writer->mutex);
+    writer->stop = true;
+    writer->wake.wakeOne();
+  }
+  writer->thread->wait();
+  NFCN_FREE(writer->thread);
+  writer->stop = false;
+
+  QMutexLocker lock(&mutex);
+  if (log_file != nullptr) {
+    log_file->flush();
+  }
+}
+
+/**
+   Starts the writer thread.
+ */
+static void log_writer_start()
+{
+  static bool exit_handler_installed = false;
+
+  if (writer->thread != nullptr) {
+    return;
+  }
+
+  /* exit() skips log_close(), stop the writer anyway so nothing queued is
+   * lost. The writer was created above, so it's destroyed after the
+   * handler runs. */
+  if (!exit_handler_installed) {
+    std::atexit(log_writer_stop);
+    exit_handler_installed = true;
+  }
+
+  writer->thread = new fcThread(log_writer_run, nullptr);
+  writer->thread->start(QThread::LowPriority);
+}
+
+/**
+   Prints a message, handling Freeciv-specific stuff before passing to
+   the Qt handler.
+ */
+static void handle_message(QtMsgType type, const QMessageLogContext &context,
+                           const QString &message)
+{
+  if (!writer.isDestroyed() && rate_limited(type, context)) {
+    return;
+  }
+
+  forward_message(type, context, message);
+}
 } // anonymous namespace
 
 /**
@@ -192,11 +442,13 @@ void log_set_file(const QString &path)
     return;
   }
 
-  // Unset the old one
-  if (log_file != nullptr) {
-    delete log_file;
+  // Write out what is still queued for the old one before replacing it
+  log_drain();
+  {
+    QMutexLocker lock(&mutex);
+    std::swap(log_file, new_file);
   }
-  log_file = new_file;
+  delete new_file;
 }
 
 /**
@@ -211,6 +463,8 @@ const QString &log_get_level() { return log_level; }
  */
 void log_close()
 {
+  log_writer_stop();
+
   QMutexLocker locker(&mutex);
 
   NFCN_FREE(log_file);